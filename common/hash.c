@@ -0,0 +1,214 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/random.h>
+#include "hash.h"
+#define WY0 0xa0761d6478bd642full
+#define WY1 0xe7037ed1a0b428dbull
+#define WORD1 0x87c37b91114253d5ull
+#define WORD2 0x4cf5ad432745937full
+
+/*
+ * This file implements the string hash functions declared in hash.h, from the byte at a time
+ * functions we started out with to ones that take in eight bytes per step and mix well enough that
+ * linear probing does not cluster. Every function takes a seed so a table can pick its own
+ * (details are commented above each function).
+ */
+
+/*
+ * Function: load64
+ * -------------------------------
+ * Summary: Reads eight bytes from anywhere, aligned or not.
+ * Runtime: O(1)
+ */
+static inline uint64_t load64(char *p) {
+	uint64_t w;
+	memcpy(&w, p, sizeof(w));
+	return w;
+}
+
+/*
+ * Function: load32
+ * -------------------------------
+ * Summary: Reads four bytes from anywhere, aligned or not.
+ * Runtime: O(1)
+ */
+static inline uint64_t load32(char *p) {
+	uint32_t w;
+	memcpy(&w, p, sizeof(w));
+	return w;
+}
+
+/*
+ * Function: mix
+ * -------------------------------
+ * Summary: Multiplies two 64 bit words into 128 bits and folds the halves together, which spreads
+ * every input bit over the whole result in one multiply.
+ * Runtime: O(1)
+ */
+static inline uint64_t mix(uint64_t a, uint64_t b) {
+	__uint128_t r = (__uint128_t) a * b;
+	return (uint64_t) r ^ (uint64_t) (r >> 64);
+}
+
+/*
+ * Function: strHash
+ * -------------------------------
+ * Summary: The hash the tables started out with: multiply by 31 and add each character, starting
+ * from the seed instead of zero. One byte per step, and the low bits of short strings barely change.
+ * Runtime: O(len)
+ */
+unsigned strHash(char *s, size_t len, unsigned long seed) {
+	unsigned hash = seed;
+	while (len-- > 0) {
+		hash = 31 * hash + *s ++;
+	}
+	return hash;
+}
+
+/*
+ * Function: fnvHash
+ * -------------------------------
+ * Summary: 32 bit FNV-1a: xor in each byte and multiply by the FNV prime. Still a byte per step,
+ * but every byte reaches every bit of the hash.
+ * Runtime: O(len)
+ */
+unsigned fnvHash(char *s, size_t len, unsigned long seed) {
+	unsigned hash = 2166136261u ^ (unsigned) (seed ^ seed >> 32);
+	while (len-- > 0) {
+		hash = (hash ^ (unsigned char) *s ++) * 16777619u;
+	}
+	return hash;
+}
+
+/*
+ * Function: wordHash
+ * -------------------------------
+ * Summary: Takes in the string eight bytes at a time, multiplying and rotating each word into the
+ * hash, and the last few bytes as one zero padded word. The length goes into the starting value
+ * and the result goes through the MurmurHash3 finalizer so the low bits depend on all of it.
+ * Runtime: O(len / 8)
+ */
+unsigned wordHash(char *s, size_t len, unsigned long seed) {
+	uint64_t hash = seed ^ len * WORD1, w;
+
+	for (; len >= 8; s += 8, len -= 8) {
+		w = load64(s) * WORD1;
+		w = (w << 31 | w >> 33) * WORD2;
+		hash ^= w;
+		hash = (hash << 27 | hash >> 37) * 5 + 0x52dce729;
+	}
+	if (len > 0) {
+		w = 0;
+		memcpy(&w, s, len);
+		w *= WORD1;
+		hash ^= (w << 31 | w >> 33) * WORD2;
+	}
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return (unsigned) hash;
+}
+
+/*
+ * Function: wyHash64
+ * -------------------------------
+ * Summary: A hash in the style of wyhash. Strings of up to sixteen bytes are read as two (possibly
+ * overlapping) words without a loop; longer ones are folded in sixteen bytes per step. Everything
+ * is combined with the 128 bit multiply in mix, and all 64 bits of the result are returned, for
+ * uses like counting distinct strings that need more than 32 bits to stay free of collisions.
+ * Runtime: O(len / 16)
+ */
+unsigned long wyHash64(char *s, size_t len, unsigned long seed) {
+	unsigned char *p = (unsigned char *) s;
+	uint64_t a, b, n = len;
+
+	seed ^= mix(seed ^ WY0, WY1);
+	if (len <= 16) {
+		if (len >= 4) {												// the first and last four bytes, and the four after
+			a = load32(s) << 32 | load32(s + (len >> 3 << 2));		// or before the middle when there are eight or more
+			b = load32(s + len - 4) << 32 | load32(s + len - 4 - (len >> 3 << 2));
+		}
+		else if (len > 0) {
+			a = (uint64_t) p[0] << 16 | (uint64_t) p[len >> 1] << 8 | p[len - 1];
+			b = 0;
+		}
+		else {
+			a = b = 0;
+		}
+	}
+	else {
+		for (; len > 16; s += 16, len -= 16) {
+			seed = mix(load64(s) ^ WY1, load64(s + 8) ^ seed);
+		}
+		a = load64(s + len - 16);									// the last sixteen bytes, which may overlap
+		b = load64(s + len - 8);									// ones already taken in
+	}
+	return mix(mix(a ^ WY1, b ^ seed) ^ WY0 ^ n, seed ^ WY1);
+}
+
+/*
+ * Function: wyHash
+ * -------------------------------
+ * Summary: The low 32 bits of wyHash64. This is the default for the hash tables.
+ * Runtime: O(len / 16)
+ */
+unsigned wyHash(char *s, size_t len, unsigned long seed) {
+	return (unsigned) wyHash64(s, len, seed);
+}
+
+/*
+ * Function: findHash
+ * -------------------------------
+ * Summary: Returns the hash function with the given name ("str", "fnv", "word", or "wy"), or NULL if
+ * there is none, so programs can let the user pick one.
+ * Runtime: O(1)
+ */
+HASHFUNC findHash(char *name) {
+	if (strcmp(name, "str") == 0)
+		return strHash;
+	if (strcmp(name, "fnv") == 0)
+		return fnvHash;
+	if (strcmp(name, "word") == 0)
+		return wordHash;
+	if (strcmp(name, "wy") == 0)
+		return wyHash;
+	return NULL;
+}
+
+/*
+ * Function: *hashName
+ * -------------------------------
+ * Summary: Returns the name findHash knows a hash function by, or NULL if it is not one of ours, so a
+ * table saved to a file can record which function it was built with.
+ * Runtime: O(1)
+ */
+char *hashName(HASHFUNC hash) {
+	if (hash == strHash)
+		return "str";
+	if (hash == fnvHash)
+		return "fnv";
+	if (hash == wordHash)
+		return "word";
+	if (hash == wyHash)
+		return "wy";
+	return NULL;
+}
+
+/*
+ * Function: randomSeed
+ * -------------------------------
+ * Summary: Returns a seed from the kernel's random number generator, or one made from the time and
+ * an address if that fails, for a table whose layout should not be predictable from its input.
+ * Runtime: O(1)
+ */
+unsigned long randomSeed(void) {
+	unsigned long seed;
+
+	if (getrandom(&seed, sizeof(seed), 0) != sizeof(seed))
+		seed = time(NULL) ^ (uintptr_t) &seed;
+	return seed;
+}
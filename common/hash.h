@@ -0,0 +1,35 @@
+/*
+ * File:	hash.h
+ *
+ * Description:	This file contains the public function and type
+ *		declarations for a family of string hash functions.  Every
+ *		function hashes LEN bytes starting at S and mixes in a SEED,
+ *		so a table can be given a random seed that input cannot be
+ *		crafted against.  With a seed of zero, strHash is the
+ *		31 * hash + c function the hash tables started out with.
+ */
+
+# ifndef HASH_H
+# define HASH_H
+
+# include <stddef.h>
+
+typedef unsigned (*HASHFUNC)(char *s, size_t len, unsigned long seed);
+
+extern unsigned strHash(char *s, size_t len, unsigned long seed);
+
+extern unsigned fnvHash(char *s, size_t len, unsigned long seed);
+
+extern unsigned wordHash(char *s, size_t len, unsigned long seed);
+
+extern unsigned wyHash(char *s, size_t len, unsigned long seed);
+
+extern unsigned long wyHash64(char *s, size_t len, unsigned long seed);
+
+extern HASHFUNC findHash(char *name);
+
+extern char *hashName(HASHFUNC hash);
+
+extern unsigned long randomSeed(void);
+
+# endif /* HASH_H */
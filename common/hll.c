@@ -0,0 +1,171 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include "hll.h"
+#include "hash.h"
+#define BITS 64
+
+/*
+ * This file implements the HyperLogLog sketch declared in hll.h (details are commented above each
+ * function). Each string is hashed to 64 bits with wyHash64. The top p bits pick a register, and the
+ * register keeps the largest rank it has seen, the rank being one more than the number of leading zeros
+ * in the other q = 64 - p bits. With 64 bit hashes there are no collisions to correct for until far more
+ * strings than we will ever see. The estimate uses the improved estimator of Ertl ("New cardinality
+ * estimation algorithms for HyperLogLog sketches", 2017), which needs no tables of empirical bias and is
+ * about as accurate for a handful of strings as for billions.
+ */
+struct sketch
+{
+	int precision; /*p, the number of hash bits that pick a register*/
+	int length; /*2^p, the number of registers*/
+	unsigned char *registers; /*the largest rank seen by each register*/
+};
+
+/*
+ * Function: *createSketch
+ * -------------------------------
+ * Summary: Allocates a sketch of the given precision with every register zero, as if it had been given no
+ * strings at all.
+ * Runtime: O(2^precision)
+ */
+SKETCH *createSketch(int precision) {
+	SKETCH *sp;
+
+	assert(precision >= MIN_PRECISION && precision <= MAX_PRECISION);
+	sp = malloc(sizeof(SKETCH));
+	assert(sp != NULL);
+	sp->precision = precision;
+	sp->length = 1 << precision;
+	sp->registers = calloc(sp->length, sizeof(unsigned char));
+	assert(sp->registers != NULL);
+	return sp;
+}
+
+/*
+ * Function: destroySketch
+ * -------------------------------
+ * Summary: Frees the registers and then the sketch.
+ * Runtime: O(1)
+ */
+void destroySketch(SKETCH *sp) {
+	assert(sp != NULL);
+	free(sp->registers);
+	free(sp);
+}
+
+/*
+ * Function: addToSketch
+ * -------------------------------
+ * Summary: Adds the len bytes at s. The bits below the register index are shifted up to the top, so the
+ * rank is the count of leading zeros plus one, or q + 1 if they are all zero.
+ * Runtime: O(len)
+ */
+void addToSketch(SKETCH *sp, char *s, size_t len) {
+	unsigned long hash = wyHash64(s, len, 0), rest;
+	unsigned char rank;
+	int index;
+
+	index = hash >> (BITS - sp->precision);
+	rest = hash << sp->precision;
+	rank = rest != 0 ? __builtin_clzl(rest) + 1 : BITS - sp->precision + 1;
+	if (rank > sp->registers[index]) {
+		sp->registers[index] = rank;
+	}
+}
+
+/*
+ * Function: mergeSketch
+ * -------------------------------
+ * Summary: Makes sp the sketch of everything sp or other was given, by keeping the larger of each pair of
+ * registers. The two must have the same precision.
+ * Runtime: O(2^precision)
+ */
+void mergeSketch(SKETCH *sp, SKETCH *other) {
+	int i;
+
+	assert(sp != NULL && other != NULL && sp->precision == other->precision);
+	for (i = 0; i < sp->length; i++) {
+		if (other->registers[i] > sp->registers[i]) {
+			sp->registers[i] = other->registers[i];
+		}
+	}
+}
+
+/*
+ * Function: sigma
+ * -------------------------------
+ * Summary: The series x + sum over k of x^(2^k) * 2^(k-1) from Ertl's paper, which corrects the estimate
+ * for the registers that are still zero. Summed until adding a term no longer changes it.
+ * Runtime: O(1), about 60 terms at worst
+ */
+static double sigma(double x) {
+	double y = 1, z = x, last;
+
+	if (x == 1) {
+		return INFINITY;
+	}
+	do {
+		x *= x;
+		last = z;
+		z += x * y;
+		y += y;
+	} while (z != last);
+	return z;
+}
+
+/*
+ * Function: tau
+ * -------------------------------
+ * Summary: The series from Ertl's paper that corrects the estimate for the registers that have reached the
+ * largest rank there is, again summed until it stops changing.
+ * Runtime: O(1), about 60 terms at worst
+ */
+static double tau(double x) {
+	double y = 1, z = 1 - x, last;
+
+	if (x == 0 || x == 1) {
+		return 0;
+	}
+	do {
+		x = sqrt(x);
+		last = z;
+		y *= 0.5;
+		z -= (1 - x) * (1 - x) * y;
+	} while (z != last);
+	return z / 3;
+}
+
+/*
+ * Function: estimateSketch
+ * -------------------------------
+ * Summary: Returns the estimated number of distinct strings given to the sketch. We count how many registers
+ * hold each rank and fold the counts from the largest rank down, as in Ertl's improved estimator, with sigma
+ * and tau standing in for the ranks below 1 and above q + 1 that the registers cannot hold.
+ * Runtime: O(2^precision)
+ */
+double estimateSketch(SKETCH *sp) {
+	int counts[BITS + 2] = {0};
+	int i, q = BITS - sp->precision;
+	double m = sp->length, z;
+
+	for (i = 0; i < sp->length; i++) {
+		counts[sp->registers[i]]++;
+	}
+	z = m * tau(1 - counts[q + 1] / m);
+	for (i = q; i >= 1; i--) {
+		z = 0.5 * (z + counts[i]);
+	}
+	z += m * sigma(counts[0] / m);
+	return m * m / (2 * M_LN2 * z);
+}
+
+/*
+ * Function: sketchError
+ * -------------------------------
+ * Summary: Returns the relative standard error of the estimate, 1.04 / sqrt(2^precision).
+ * Runtime: O(1)
+ */
+double sketchError(SKETCH *sp) {
+	return 1.04 / sqrt(sp->length);
+}
@@ -0,0 +1,39 @@
+/*
+ * File:	hll.h
+ *
+ * Description:	This file contains the public function and type
+ *		declarations for a HyperLogLog sketch, which estimates how
+ *		many distinct strings it has been given in a fixed amount of
+ *		memory.  A sketch of precision p has 2^p one byte registers
+ *		and a relative standard error of about 1.04 / sqrt(2^p), so
+ *		the default of 14 takes 16 KB for an error under 1%.  Two
+ *		sketches of the same precision can be merged, and the result
+ *		is the sketch of everything either was given, so the strings
+ *		can be sketched in pieces (by different threads, or from
+ *		different files) and put together afterwards.
+ */
+
+# ifndef HLL_H
+# define HLL_H
+
+# include <stddef.h>
+
+# define MIN_PRECISION 4
+# define MAX_PRECISION 18
+# define DEFAULT_PRECISION 14
+
+typedef struct sketch SKETCH;
+
+extern SKETCH *createSketch(int precision);
+
+extern void destroySketch(SKETCH *sp);
+
+extern void addToSketch(SKETCH *sp, char *s, size_t len);
+
+extern void mergeSketch(SKETCH *sp, SKETCH *other);
+
+extern double estimateSketch(SKETCH *sp);
+
+extern double sketchError(SKETCH *sp);
+
+# endif /* HLL_H */
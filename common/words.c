@@ -0,0 +1,309 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "words.h"
+#define START_LENGTH 65536
+
+/*
+ * This file defines the struct called words and implements a tokenizer that splits a file into
+ * whitespace separated words without going through stdio. The file is mapped into memory (or read
+ * into a buffer if it cannot be mapped, e.g. a pipe) and the whitespace tests are done sixteen bytes
+ * at a time with SSE2 where it is available (details are commented above each function).
+ */
+struct words
+{
+	char *data;	/* start of the text */
+	char *next;	/* where the next scan begins */
+	char *end;	/* one past the last byte of the text */
+	size_t length; /* length of the mapping */
+	bool mapped; /* whether data came from mmap or malloc */
+	bool shared; /* a part made by splitWords, which does not own the text */
+};
+
+/*
+ * Function: isSpace
+ * -------------------------------
+ * Summary: Returns whether a byte is whitespace in the sense of isspace() in the "C" locale, which is
+ * what fscanf("%s") splits on: a blank or one of \t \n \v \f \r (9 through 13).
+ * Runtime: O(1)
+ */
+static inline bool isSpace(unsigned char c) {
+	return c == ' ' || (unsigned char) (c - '\t') < 5;
+}
+
+#ifdef __SSE2__
+/*
+ * Function: spaceMask
+ * -------------------------------
+ * Summary: Classifies sixteen bytes at once and returns a bit mask with bit i set if p[i] is
+ * whitespace. The range test 9..13 is done with a signed compare by first shifting the range down
+ * to the bottom of the signed byte range.
+ * Runtime: O(1)
+ */
+static inline unsigned spaceMask(char *p) {
+	__m128i v = _mm_loadu_si128((__m128i *) p);
+	__m128i blank = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+	__m128i ctrl = _mm_cmplt_epi8(_mm_add_epi8(v, _mm_set1_epi8(0x80 - '\t')), _mm_set1_epi8(-128 + 5));
+	return _mm_movemask_epi8(_mm_or_si128(blank, ctrl));
+}
+
+/*
+ * Function: lineMask
+ * -------------------------------
+ * Summary: Returns a bit mask with bit i set if p[i] is a newline.
+ * Runtime: O(1)
+ */
+static inline unsigned lineMask(char *p) {
+	__m128i v = _mm_loadu_si128((__m128i *) p);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+}
+#endif
+
+/*
+ * Function: skipSpace
+ * -------------------------------
+ * Summary: Returns a pointer to the first non-whitespace byte in [p, end), or end if there is none.
+ * Runtime: O(n)
+ */
+char *skipSpace(char *p, char *end) {
+#ifdef __SSE2__
+	unsigned mask;
+
+	while (end - p >= 16) {
+		mask = spaceMask(p) ^ 0xFFFF;				// set bits are now the non-whitespace bytes
+		if (mask != 0)
+			return p + __builtin_ctz(mask);
+		p += 16;
+	}
+#endif
+	while (p < end && isSpace(*p))
+		p++;
+	return p;
+}
+
+/*
+ * Function: skipWord
+ * -------------------------------
+ * Summary: Returns a pointer to the first whitespace byte in [p, end), or end if there is none.
+ * Runtime: O(n)
+ */
+char *skipWord(char *p, char *end) {
+#ifdef __SSE2__
+	unsigned mask;
+
+	while (end - p >= 16) {
+		mask = spaceMask(p);
+		if (mask != 0)
+			return p + __builtin_ctz(mask);
+		p += 16;
+	}
+#endif
+	while (p < end && !isSpace(*p))
+		p++;
+	return p;
+}
+
+/*
+ * Function: countWords
+ * -------------------------------
+ * Summary: Counts the words that start in [p, end) and the newlines in it. A word starts at a
+ * non-whitespace byte whose previous byte is whitespace (or which is the first byte of the text), so
+ * we look one byte behind p. That way a word straddling two ranges is only counted by the range it
+ * starts in, and the text can be cut anywhere and counted piece by piece. The counts are added to
+ * *wordsp and *linesp.
+ * Runtime: O(n)
+ */
+void countWords(char *text, char *p, char *end, long *wordsp, long *linesp) {
+	long words = 0, lines = 0;
+	bool space = p == text || isSpace(p[-1]);		// whether the byte before p is whitespace
+#ifdef __SSE2__
+	unsigned mask;
+
+	while (end - p >= 16) {
+		mask = spaceMask(p);
+		words += __builtin_popcount(~mask & (mask << 1 | space) & 0xFFFF);
+		lines += __builtin_popcount(lineMask(p));
+		space = mask >> 15;
+		p += 16;
+	}
+#endif
+	while (p < end) {
+		if (isSpace(*p)) {
+			lines += *p == '\n';
+			space = true;
+		} else {
+			words += space;
+			space = false;
+		}
+		p++;
+	}
+	*wordsp += words;
+	*linesp += lines;
+}
+
+/*
+ * Function: readAll
+ * -------------------------------
+ * Summary: Reads everything from a descriptor that cannot be mapped into a malloc'd buffer, doubling
+ * the buffer whenever it fills up.
+ * Runtime: O(n)
+ */
+static void readAll(WORDS *wp, int fd) {
+	size_t count = 0, length = START_LENGTH;
+	ssize_t n;
+
+	wp->data = malloc(length);
+	assert(wp->data!=NULL);
+
+	while ((n = read(fd, wp->data + count, length - count)) > 0) {
+		count += n;
+		if (count == length) {
+			length *= 2;
+			wp->data = realloc(wp->data, length);
+			assert(wp->data!=NULL);
+		}
+	}
+	wp->mapped = false;
+	wp->length = count;
+}
+
+/*
+ * Function: *openWords
+ * -------------------------------
+ * Summary: Opens a file ("-" for the standard input) and maps it read-only into memory. Regular files
+ * are mapped; anything else falls back to being read into memory. Returns NULL if the file cannot be
+ * opened.
+ * Runtime: O(1) for a mapped file, O(n) otherwise
+ */
+WORDS *openWords(char *path) {
+	WORDS *wp;
+	struct stat st;
+	int fd;
+
+	if (strcmp(path, "-") == 0)
+		fd = dup(STDIN_FILENO);							// "-" is the standard input, as usual
+	else
+		fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	wp = malloc(sizeof(WORDS));
+	assert(wp!=NULL);
+
+	wp->data = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		wp->data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (wp->data != MAP_FAILED) {
+			madvise(wp->data, st.st_size, MADV_SEQUENTIAL);		// we only ever walk forward
+			wp->mapped = true;
+			wp->length = st.st_size;
+		}
+	}
+	if (wp->data == MAP_FAILED)
+		readAll(wp, fd);
+	close(fd);											// the mapping stays valid after the close
+
+	wp->next = wp->data;
+	wp->end = wp->data + wp->length;
+	wp->shared = false;
+	return wp;
+}
+
+/*
+ * Function: closeWords
+ * -------------------------------
+ * Summary: Unmaps (or frees) the text and frees the tokenizer. Any views returned by nextWord are
+ * no longer valid after this. A part made by splitWords only frees itself.
+ * Runtime: O(1)
+ */
+void closeWords(WORDS *wp) {
+	assert(wp!=NULL);
+	if (wp->shared)
+		;
+	else if (wp->mapped)
+		munmap(wp->data, wp->length);
+	else
+		free(wp->data);
+	free(wp);
+}
+
+/*
+ * Function: *nextWord
+ * -------------------------------
+ * Summary: Returns a pointer to the start of the next word and stores its length in *lenp. The word
+ * is NOT null terminated since it points straight into the text. Returns NULL at the end of the text.
+ * Runtime: O(length of the word and the whitespace before it)
+ */
+char *nextWord(WORDS *wp, size_t *lenp) {
+	assert(wp!=NULL && lenp!=NULL);
+	char *word = skipSpace(wp->next, wp->end);
+
+	if (word == wp->end)
+		return NULL;
+
+	wp->next = skipWord(word, wp->end);
+	*lenp = wp->next - word;
+	return word;
+}
+
+/*
+ * Function: readWord
+ * -------------------------------
+ * Summary: A drop in replacement for fscanf(fp, "%s", buf) for callers that need a null terminated
+ * string. Copies the next word into buf and returns 1, or returns 0 at the end of the text. Unlike
+ * fscanf, a word longer than size - 1 bytes is truncated rather than overflowing buf.
+ * Runtime: O(length of the word)
+ */
+int readWord(WORDS *wp, char *buf, size_t size) {
+	size_t len;
+	char *word = nextWord(wp, &len);
+
+	if (word == NULL)
+		return 0;
+
+	if (len >= size)
+		len = size - 1;
+	memcpy(buf, word, len);
+	buf[len] = '\0';
+	return 1;
+}
+
+/*
+ * Function: splitWords
+ * -------------------------------
+ * Summary: Splits the words not read yet into at most n parts of about the same size, so that they
+ * can be read by different threads. Each cut is moved forward to the end of the word it falls in, so
+ * no word is split. The tokenizers for the parts are stored in parts and the number of them is
+ * returned (fewer than n if there is not much text). The parts share the text with wp, so they must
+ * be closed before it is, and wp itself has nothing left to read.
+ * Runtime: O(n)
+ */
+int splitWords(WORDS *wp, WORDS **parts, int n) {
+	assert(wp!=NULL && parts!=NULL);
+	char *start = skipSpace(wp->next, wp->end), *cut;
+	int count = 0;
+
+	while (count < n && start < wp->end) {
+		cut = skipWord(start + (wp->end - start) / (n - count), wp->end);
+		parts[count] = malloc(sizeof(WORDS));
+		assert(parts[count]!=NULL);
+		parts[count]->data = parts[count]->next = start;
+		parts[count]->end = cut;
+		parts[count]->length = cut - start;
+		parts[count]->mapped = false;
+		parts[count]->shared = true;
+		count++;
+		start = skipSpace(cut, wp->end);
+	}
+	wp->next = wp->end;
+	return count;
+}
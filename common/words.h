@@ -0,0 +1,35 @@
+/*
+ * File:	words.h
+ *
+ * Description:	This file contains the public function and type
+ *		declarations for a word tokenizer.  The input file is
+ *		mapped into memory and split on the same whitespace
+ *		characters that fscanf("%s") uses.  Words are returned as
+ *		views (a pointer and a length) into the mapped text, so
+ *		nothing is copied unless the caller asks for it.
+ */
+
+# ifndef WORDS_H
+# define WORDS_H
+
+# include <stddef.h>
+
+typedef struct words WORDS;
+
+extern WORDS *openWords(char *path);
+
+extern void closeWords(WORDS *wp);
+
+extern char *nextWord(WORDS *wp, size_t *lenp);
+
+extern int readWord(WORDS *wp, char *buf, size_t size);
+
+extern char *skipSpace(char *p, char *end);
+
+extern char *skipWord(char *p, char *end);
+
+extern int splitWords(WORDS *wp, WORDS **parts, int n);
+
+extern void countWords(char *text, char *p, char *end, long *wordsp, long *linesp);
+
+# endif /* WORDS_H */
@@ -1,20 +1,217 @@
 #include <stdio.h>
-#define MAX_WORD_LENGTH 30
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "words.h"
+#define MIN_CHUNK (1 << 20)
+#define MAX_THREADS 256
+#define STREAM_SIZE (1 << 20)
+
+struct file {				// One file named on the command line and its counts
+  char *name;
+  off_t size;
+  bool stream;				// Not a regular file (e.g. a pipe), so it has to be read front to back
+  int error;				// The errno of the first thing that went wrong, or 0
+  int chunks;				// How many byte ranges it is cut into
+  long words;
+  long lines;
+  long bytes;
+};
+
+struct task {				// One byte range of one file and what was counted in it
+  struct file *fp;
+  off_t start;
+  off_t end;
+  long words;
+  long lines;
+  long bytes;
+  int error;
+};
+
+static struct task *tasks;		// The work list, biggest range first
+static int numOfTasks;
+static int nextTask = 0;		// The next task a thread should take
+
+static int openFile(struct file *fp) {	// "-" is the standard input, like wc
+  if (strcmp(fp->name,"-") == 0)
+    return dup(STDIN_FILENO);
+  return open(fp->name,O_RDONLY);
+}
+
+static void countStream(struct task *tp, int fd) {
+  char *buffer = malloc(STREAM_SIZE + 1);	// buffer[0] holds the last byte of the previous read so that
+  ssize_t n;					// a word split across two reads is only counted once
+  if (buffer == NULL) {
+    tp->error = ENOMEM;
+    return;
+  }
+  buffer[0] = ' ';
+  while ((n = read(fd,buffer+1,STREAM_SIZE)) > 0) {
+    countWords(buffer,buffer+1,buffer+1+n,&tp->words,&tp->lines);
+    tp->bytes += n;
+    buffer[0] = buffer[n];
+  }
+  if (n < 0)
+    tp->error = errno;
+  free(buffer);
+}
+
+static void countRange(struct task *tp, int fd) {
+  long page = sysconf(_SC_PAGESIZE);
+  off_t base = tp->start > 0 ? (tp->start - 1) / page * page : 0;	// Map from one byte before the range (rounded down
+  size_t length = tp->end - base;					// to a page) so countWords can tell if the range
+  char *text = mmap(NULL,length,PROT_READ,MAP_PRIVATE,fd,base);		// begins in the middle of a word
+  if (text == MAP_FAILED) {
+    tp->error = errno;
+    return;
+  }
+  char *start = text + (tp->start - base);
+  countWords(tp->start > 0 ? text : start,start,text + length,&tp->words,&tp->lines);
+  tp->bytes = tp->end - tp->start;
+  munmap(text,length);
+}
+
+static void *worker(void *arg) {
+  int i, fd;
+  while ((i = __atomic_fetch_add(&nextTask,1,__ATOMIC_RELAXED)) < numOfTasks) {
+    struct task *tp = &tasks[i];
+    if ((fd = openFile(tp->fp)) < 0) {
+      tp->error = errno;
+      continue;
+    }
+    if (tp->fp->stream)
+      countStream(tp,fd);
+    else if (tp->end > tp->start)
+      countRange(tp,fd);
+    close(fd);
+  }
+  return NULL;
+}
+
+static int compareTasks(const void *a, const void *b) {	// Streams first (their size is unknown), then largest first
+  const struct task *t1 = a, *t2 = b;
+  if (t1->fp->stream != t2->fp->stream)
+    return t2->fp->stream - t1->fp->stream;
+  off_t d = (t2->end - t2->start) - (t1->end - t1->start);
+  return d < 0 ? -1 : d > 0;
+}
+
+static void print(long lines, long words, long bytes, char *name) {
+  printf("%8ld %8ld %8ld",lines,words,bytes);
+  if (name != NULL)
+    printf(" %s",name);
+  printf("\n");
+}
 
 int main(int argc, char* argv[]) {
-  if(argc != 2){				// Check to see if the number of arguments is 2
-    return 0;
+  int numOfThreads = sysconf(_SC_NPROCESSORS_ONLN);	// By default we use one thread per core
+  if(argc > 2 && strcmp(argv[1],"-j") == 0){	// An optional -j sets the number of threads
+    numOfThreads = atoi(argv[2]);
+    argv[2] = argv[0];
+    argv += 2;
+    argc -= 2;
+  }
+  if(numOfThreads < 1){
+    fprintf(stderr,"usage: %s [-j threads] [file ...]\n",argv[0]);
+    return 1;
+  }
+  if (numOfThreads > MAX_THREADS)
+    numOfThreads = MAX_THREADS;
+
+  int numOfFiles = argc > 1 ? argc - 1 : 1;	// With no files we count the standard input
+  struct file *files = calloc(numOfFiles,sizeof(struct file));
+  if (files == NULL) {
+    perror(argv[0]);
+    return 1;
   }
-  FILE *fp = fopen(argv[1],"r");		// Initialize pointer to file and open it to be read
-  if (fp == NULL) {				// Check to see if the file exists.
-    return 0;
+  int i, j, k;
+  struct stat st;
+  for (i = 0; i < numOfFiles; i++) {		// Look at each file's size to decide how to split it up
+    files[i].name = argc > 1 ? argv[i+1] : "-";
+    int fd = openFile(&files[i]);
+    if (fd < 0 || fstat(fd,&st) < 0) {
+      files[i].error = errno;
+    } else if (S_ISREG(st.st_mode)) {
+      files[i].size = st.st_size;
+    } else {
+      files[i].stream = true;
+    }
+    if (fd >= 0)
+      close(fd);
+  }
+
+  numOfTasks = 0;
+  for (i = 0; i < numOfFiles; i++) {		// Cut each file into equal byte ranges of at least MIN_CHUNK bytes,
+    if (files[i].error != 0)			// at most one per thread, and count them to size the work list
+      continue;
+    k = files[i].stream ? 1 : files[i].size / MIN_CHUNK;
+    if (k > numOfThreads)
+      k = numOfThreads;
+    if (k < 1)
+      k = 1;
+    files[i].chunks = k;
+    numOfTasks += k;
+  }
+
+  tasks = malloc(sizeof(struct task) * (numOfTasks > 0 ? numOfTasks : 1));
+  if (tasks == NULL) {
+    perror(argv[0]);
+    return 1;
+  }
+  numOfTasks = 0;
+  for (i = 0; i < numOfFiles; i++) {		// A word that straddles a cut is counted by the range it starts in
+    k = files[i].chunks;			// (see countWords)
+    for (j = 0; j < k; j++) {
+      struct task *tp = &tasks[numOfTasks++];
+      memset(tp,0,sizeof(struct task));
+      tp->fp = &files[i];
+      tp->start = files[i].size * j / k;
+      tp->end = files[i].size * (j+1) / k;
+    }
+  }
+  qsort(tasks,numOfTasks,sizeof(struct task),compareTasks);	// Largest first, so no thread is left with
+								// a big file at the end while the rest sit idle
+  pthread_t threads[MAX_THREADS];
+  int started;
+  for (started = 1; started < numOfThreads; started++)	// If a thread cannot be made, the ones we have
+    if (pthread_create(&threads[started],NULL,worker,NULL) != 0)	// take its share of the tasks
+      break;
+  worker(NULL);					// The main thread works too
+  for (i = 1; i < started; i++)
+    pthread_join(threads[i],NULL);
+
+  for (i = 0; i < numOfTasks; i++) {		// Add up the ranges of each file
+    struct file *fp = tasks[i].fp;
+    if (fp->error == 0)
+      fp->error = tasks[i].error;
+    fp->words += tasks[i].words;
+    fp->lines += tasks[i].lines;
+    fp->bytes += tasks[i].bytes;
   }
-  int numOfWords = 0;				// Create a variable to count the number of words
-  char singleWord[MAX_WORD_LENGTH+1];		// Allocate memory to store the word in a character array
 
-  while(fscanf(fp,"%s",singleWord)==1) {	// The while loop checks to see if a word is read. If so, then we increment the 
-    numOfWords++;				// numOfWords variable. (If it's not, fscanf will return 0, and the loop will exit)
+  long numOfWords = 0, numOfLines = 0, numOfBytes = 0;
+  int status = 0;
+  for (i = 0; i < numOfFiles; i++) {		// We print the counts for each file in the order given, like wc
+    if (files[i].error != 0) {			// Say what went wrong, as wc does
+      fprintf(stderr,"%s: %s: %s\n",argv[0],files[i].name,strerror(files[i].error));
+      status = 1;
+      continue;
+    }
+    print(files[i].lines,files[i].words,files[i].bytes,argc > 1 ? files[i].name : NULL);
+    numOfWords += files[i].words;
+    numOfLines += files[i].lines;
+    numOfBytes += files[i].bytes;
   }
+  if (numOfFiles > 1)				// and the totals if there was more than one
+    print(numOfLines,numOfWords,numOfBytes,"total");
 
-  printf("%d total words\n",numOfWords);	// We print the final number of words.
+  free(tasks);
+  free(files);
+  return status;
 }
@@ -0,0 +1,707 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "set.h"
+#define MAX_KEYS 7
+#define MIN_KEYS (MAX_KEYS/2)
+#define CACHE_LINE 64
+
+/*
+ * This file defines the struct called set (specifically a B+tree) and implements its different
+ * functions including creating and destroying the set, adding and removing elements, and searching
+ * (details are commented above each function). Every element lives in a leaf, the leaves are linked
+ * together in sorted order, and the internal nodes only hold copies of keys to route searches. A node
+ * is two cache lines, so a search touches O(log n) lines and an insert or delete does a bounded amount
+ * of work on each level instead of shifting the whole array like sorted.c does.
+ */
+
+/*
+ * Struct: node
+ * -------------------------------
+ * Summary: A node of the tree. In an internal node, children[i] holds the elements that are less than
+ * keys[i] and children[i+1] the ones that are greater or equal. Leaves use next instead of children.
+ */
+struct node
+{
+	int count;	/* number of keys */
+	bool leaf;	/* whether this is a leaf */
+	char *keys[MAX_KEYS]; /* keys in sorted order */
+	union {
+		struct node *children[MAX_KEYS+1]; /* subtrees of an internal node */
+		struct node *next; /* next leaf in order */
+	};
+};
+
+struct set
+{
+	int count;	/*number of elements*/
+	struct node *root; /*root of the tree */
+	struct node *first; /*leftmost leaf */
+};
+typedef struct set SET;
+
+/*
+ * Function: *createNode
+ * -------------------------------
+ * Summary: Allocates an empty node aligned to a cache line, so a node never straddles more lines
+ * than it has to.
+ * Runtime: O(1)
+ */
+static struct node *createNode(bool leaf){
+	struct node *np = aligned_alloc(CACHE_LINE, sizeof(struct node));
+	assert(np!=NULL);
+	np->count = 0;
+	np->leaf = leaf;
+	np->next = NULL;
+	return np;
+}
+
+/*
+ * Function: *createSet
+ * -------------------------------
+ * Summary: Allocates the set with a single empty leaf as the root. The tree grows as needed, so maxElts
+ * is not used.
+ * Runtime: O(1)
+ */
+SET *createSet(int maxElts){
+	SET *sp;
+
+	sp=malloc(sizeof(SET));						// declare set and allocate memory
+	assert(sp!=NULL);
+
+	sp->count = 0;
+	sp->root = sp->first = createNode(true);
+	return sp;
+}
+
+/*
+ * Function: destroyNode
+ * --------------------------------
+ * Summary: Frees a subtree: the strings held by leaves, the key copies held by internal nodes, and the
+ * nodes themselves.
+ * Runtime: O(n)
+ */
+static void destroyNode(struct node *np){
+	int i;
+
+	for (i=0;i<np->count;i++){
+		free(np->keys[i]);
+	}
+	if (!np->leaf){
+		for (i=0;i<=np->count;i++){
+			destroyNode(np->children[i]);
+		}
+	}
+	free(np);
+}
+
+/*
+ * Function: destroySet
+ * --------------------------------
+ * Summary: Destroys the set by freeing the tree and then the set
+ * Runtime: O(n)
+ */
+void destroySet(SET *sp){
+	assert(sp!=NULL);
+	destroyNode(sp->root);
+	free(sp);
+}
+
+/*
+ * Function: numElements
+ * ----------------------------------
+ * Summary: Simply returns the number of elements in the set
+ * Runtime: O(1)
+ */
+int numElements(SET *sp){
+	assert(sp!=NULL);
+	return sp->count;
+}
+
+/*
+ * Function: search
+ * ------------------------------------
+ * Summary: Searches a single node. Returns the number of keys that are less than or equal to elt, which
+ * in an internal node is the index of the child to descend into. *found is set if elt is one of the keys
+ * (it is then keys[index-1]). A node only has a handful of keys, so a linear scan is as fast as a binary
+ * search here.
+ * Runtime: O(1)
+ */
+static int search(struct node *np, char *elt, bool *found){
+	int i, diff;
+
+	*found = false;
+	for (i=0;i<np->count;i++){
+		diff = strcmp(elt, np->keys[i]);
+		if (diff < 0)
+			break;
+		if (diff == 0){
+			*found = true;
+			return i+1;
+		}
+	}
+	return i;
+}
+
+/*
+ * Function: *findLeaf
+ * ------------------------------------
+ * Summary: Walks from the root down to the leaf that would hold elt.
+ * Runtime: O(logn)
+ */
+static struct node *findLeaf(SET *sp, char *elt){
+	struct node *np = sp->root;
+	bool found;
+
+	while (!np->leaf){
+		np = np->children[search(np, elt, &found)];
+	}
+	return np;
+}
+
+/*
+ * Function: place
+ * -------------------------------------
+ * Summary: Puts elt at keys[index] of np, and child (if np is internal) to its right. If np overflows it
+ * is split in half: the upper half moves to a new node which is returned along with the key that
+ * separates the two (through *sepp), for the caller to insert into the parent. Returns NULL if np did
+ * not split.
+ * Runtime: O(1)
+ */
+static struct node *place(struct node *np, int index, char *elt, struct node *child, char **sepp){
+	struct node *right;
+	int i, half;
+
+	if (np->count < MAX_KEYS){
+		for (i = np->count; i > index; i--){		// shift everything to the right to make room
+			np->keys[i] = np->keys[i-1];
+			if (!np->leaf)
+				np->children[i+1] = np->children[i];
+		}
+		np->keys[index] = elt;
+		if (!np->leaf)
+			np->children[index+1] = child;
+		np->count++;
+		return NULL;
+	}
+
+	// the node is full, so split it. We build the MAX_KEYS+1 keys in a temporary array first.
+	char *keys[MAX_KEYS+1];
+	struct node *children[MAX_KEYS+2];
+
+	for (i = 0; i < index; i++){
+		keys[i] = np->keys[i];
+	}
+	keys[index] = elt;
+	for (i = index; i < MAX_KEYS; i++){
+		keys[i+1] = np->keys[i];
+	}
+	if (!np->leaf){
+		for (i = 0; i <= index; i++){
+			children[i] = np->children[i];
+		}
+		children[index+1] = child;
+		for (i = index+1; i <= MAX_KEYS; i++){
+			children[i+1] = np->children[i];
+		}
+	}
+
+	right = createNode(np->leaf);
+	half = (MAX_KEYS+1)/2;
+	if (np->leaf){
+		// leaves keep every key, and the separator is a copy of the first key of the right leaf
+		np->count = half;
+		right->count = MAX_KEYS+1 - half;
+		memcpy(np->keys, keys, sizeof(char*)*np->count);
+		memcpy(right->keys, keys+half, sizeof(char*)*right->count);
+		right->next = np->next;
+		np->next = right;
+		*sepp = strdup(right->keys[0]);
+	}
+	else {
+		// internal nodes push the middle key up to the parent
+		np->count = half;
+		right->count = MAX_KEYS - half;
+		memcpy(np->keys, keys, sizeof(char*)*np->count);
+		memcpy(np->children, children, sizeof(struct node*)*(np->count+1));
+		memcpy(right->keys, keys+half+1, sizeof(char*)*right->count);
+		memcpy(right->children, children+half+1, sizeof(struct node*)*(right->count+1));
+		*sepp = keys[half];
+	}
+	return right;
+}
+
+/*
+ * Function: insert
+ * -------------------------------------
+ * Summary: Inserts elt into the subtree rooted at np, placing it in its leaf and then placing the
+ * separator of each node that splits in its parent on the way back up. Returns the new right node and
+ * its separator, as place does, if np split. *added is set if elt was not already in the set.
+ * Runtime: O(logn)
+ */
+static struct node *insert(struct node *np, char *elt, char **sepp, bool *added){
+	struct node *child;
+	char *sep;
+	bool found;
+	int index;
+
+	index = search(np, elt, &found);
+	if (np->leaf){
+		if (found){
+			*added = false;
+			return NULL;
+		}
+		elt = strdup(elt);
+		child = NULL;
+		*added = true;
+	}
+	else {
+		child = insert(np->children[index], elt, &sep, added);
+		if (child == NULL){
+			return NULL;
+		}
+		elt = sep;								// the child split, so its separator goes in here
+	}
+	return place(np, index, elt, child, sepp);
+}
+
+/*
+ * Function: grow
+ * -------------------------------------
+ * Summary: Gives the tree a new root above the old one after the old root split into it and right.
+ * Runtime: O(1)
+ */
+static void grow(SET *sp, struct node *right, char *sep){
+	struct node *root = createNode(false);
+
+	root->count = 1;
+	root->keys[0] = sep;
+	root->children[0] = sp->root;
+	root->children[1] = right;
+	sp->root = root;
+}
+
+/*
+ * Function: shrink
+ * -------------------------------------
+ * Summary: If the root is an internal node with a single child left, that child becomes the root and
+ * the tree gets shorter.
+ * Runtime: O(1)
+ */
+static void shrink(SET *sp){
+	struct node *root = sp->root;
+
+	if (!root->leaf && root->count == 0){
+		sp->root = root->children[0];
+		free(root);
+	}
+}
+
+/*
+ * Function: addElement
+ * -------------------------------------
+ * Summary: Inserts the element into its leaf. If the root splits, the tree grows a new root above it.
+ * Runtime: O(logn)
+ */
+void addElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	struct node *right;
+	char *sep;
+	bool added;
+
+	right = insert(sp->root, elt, &sep, &added);
+	if (right != NULL){
+		grow(sp, right, sep);
+	}
+	if (added)
+		sp->count++;
+}
+
+/*
+ * Function: addElements
+ * -------------------------------------
+ * Summary: Adds a batch of elements. Each insert is already O(logn), so this just calls addElement.
+ * Runtime: O(m logn)
+ */
+void addElements(SET *sp, char **elts, int n){
+	assert(sp!=NULL && elts!=NULL);
+	int i;
+
+	for (i = 0; i < n; i++){
+		addElement(sp, elts[i]);
+	}
+}
+
+/*
+ * Function: removeKey
+ * ------------------------------------
+ * Summary: Removes keys[index] (and children[index+1] if internal) from a node, shifting the rest left.
+ * Runtime: O(1)
+ */
+static void removeKey(struct node *np, int index){
+	int i;
+
+	for (i = index+1; i < np->count; i++){
+		np->keys[i-1] = np->keys[i];
+		if (!np->leaf)
+			np->children[i] = np->children[i+1];
+	}
+	np->count--;
+}
+
+/*
+ * Function: rebalance
+ * ------------------------------------
+ * Summary: Fixes up children[index] of np after it fell below MIN_KEYS. If a neighbouring sibling has a
+ * key to spare we borrow one (rotating it through the separator in np); otherwise the child is merged
+ * with a sibling and np loses a key.
+ * Runtime: O(1)
+ */
+static void rebalance(struct node *np, int index){
+	struct node *child, *left, *right;
+	int i;
+
+	child = np->children[index];
+	left = index > 0 ? np->children[index-1] : NULL;
+	right = index < np->count ? np->children[index+1] : NULL;
+
+	if (right != NULL && right->count > MIN_KEYS){			// borrow the first key of the right sibling
+		if (child->leaf){
+			child->keys[child->count] = right->keys[0];
+			free(np->keys[index]);
+			removeKey(right, 0);
+			np->keys[index] = strdup(right->keys[0]);
+		}
+		else {
+			child->keys[child->count] = np->keys[index];
+			child->children[child->count+1] = right->children[0];
+			np->keys[index] = right->keys[0];
+			right->children[0] = right->children[1];
+			removeKey(right, 0);
+		}
+		child->count++;
+	}
+	else if (left != NULL && left->count > MIN_KEYS){		// borrow the last key of the left sibling
+		for (i = child->count; i > 0; i--){
+			child->keys[i] = child->keys[i-1];
+		}
+		if (child->leaf){
+			child->keys[0] = left->keys[left->count-1];
+			free(np->keys[index-1]);
+			np->keys[index-1] = strdup(child->keys[0]);
+		}
+		else {
+			for (i = child->count+1; i > 0; i--){
+				child->children[i] = child->children[i-1];
+			}
+			child->keys[0] = np->keys[index-1];
+			child->children[0] = left->children[left->count];
+			np->keys[index-1] = left->keys[left->count-1];
+		}
+		left->count--;
+		child->count++;
+	}
+	else {													// merge with a sibling
+		if (right == NULL){									// always merge the right node into the left one
+			right = child;
+			child = left;
+			index--;
+		}
+		if (child->leaf){
+			free(np->keys[index]);							// a leaf separator is only a copy
+			child->next = right->next;
+		}
+		else {
+			child->keys[child->count++] = np->keys[index];	// an internal separator comes down
+			memcpy(child->children+child->count, right->children, sizeof(struct node*)*(right->count+1));
+		}
+		memcpy(child->keys+child->count, right->keys, sizeof(char*)*right->count);
+		child->count += right->count;
+		free(right);
+		removeKey(np, index);
+	}
+}
+
+/*
+ * Function: delete
+ * ------------------------------------
+ * Summary: Removes elt from the subtree rooted at np and returns whether it was there. A child that
+ * underflows is rebalanced on the way back up.
+ * Runtime: O(logn)
+ */
+static bool delete(struct node *np, char *elt){
+	bool found;
+	int index = search(np, elt, &found);
+
+	if (np->leaf){
+		if (found){
+			free(np->keys[index-1]);
+			removeKey(np, index-1);
+		}
+		return found;
+	}
+
+	if (!delete(np->children[index], elt))
+		return false;
+	if (np->children[index]->count < MIN_KEYS)
+		rebalance(np, index);
+	return true;
+}
+
+/*
+ * Function: removeElement
+ * ------------------------------------
+ * Summary: Removes the element from its leaf. If the root ends up as an internal node with a single
+ * child, that child becomes the root and the tree gets shorter.
+ * Runtime: O(logn)
+ */
+void removeElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+
+	if (delete(sp->root, elt)){
+		sp->count--;
+		shrink(sp);
+	}
+}
+
+/*
+ * Function: toggle
+ * ------------------------------------
+ * Summary: Removes elt from the subtree rooted at np if it is there and inserts it if not, in one walk down
+ * to its leaf. On the way back up, a child that split is placed as in insert, and a child that underflowed
+ * is rebalanced as in delete. Returns the new right node if np split, and sets *added as insert does.
+ * Runtime: O(logn)
+ */
+static struct node *toggle(struct node *np, char *elt, char **sepp, bool *added){
+	struct node *child;
+	char *sep;
+	bool found;
+	int index = search(np, elt, &found);
+
+	if (np->leaf){
+		*added = !found;
+		if (found){
+			free(np->keys[index-1]);
+			removeKey(np, index-1);
+			return NULL;
+		}
+		return place(np, index, strdup(elt), NULL, sepp);
+	}
+
+	child = toggle(np->children[index], elt, &sep, added);
+	if (child != NULL)
+		return place(np, index, sep, child, sepp);
+	if (!*added && np->children[index]->count < MIN_KEYS)
+		rebalance(np, index);
+	return NULL;
+}
+
+/*
+ * Function: toggleElement
+ * ------------------------------------
+ * Summary: Removes the element if it is in the set and adds it if not, walking down the tree once. The root
+ * grows or shrinks as in addElement and removeElement. Returns whether the element was added.
+ * Runtime: O(logn)
+ */
+bool toggleElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	struct node *right;
+	char *sep;
+	bool added;
+
+	right = toggle(sp->root, elt, &sep, &added);
+	if (right != NULL){
+		grow(sp, right, sep);
+	}
+	if (added){
+		sp->count++;
+	}
+	else {
+		sp->count--;
+		shrink(sp);
+	}
+	return added;
+}
+
+/*
+ * Function: *findElement
+ * -------------------------------------
+ * Summary: Walks down to the leaf and searches it. Returns the element if found, otherwise NULL.
+ * Runtime: O(logn)
+ */
+char *findElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool found;
+	struct node *np = findLeaf(sp, elt);
+	int index = search(np, elt, &found);
+
+	return found ? np->keys[index-1] : NULL;
+}
+
+/*
+ * Function: **getElements
+ * ----------------------------------
+ * Summary: getElements returns a copy of the elements in sorted order by walking the linked leaves.
+ * Runtime: O(n)
+ */
+char **getElements(SET *sp){
+	assert(sp!=NULL);
+	char **arr;
+	struct node *np;
+	int i, j = 0;
+
+	arr = malloc(sizeof(char*)*sp->count);		// declare array and allocate memory to be size of the number of elements
+	for (np = sp->first; np != NULL; np = np->next){
+		for (i = 0; i < np->count; i++){
+			arr[j++] = strdup(np->keys[i]);		// copy the data
+		}
+	}
+	return arr;
+}
+
+/*
+ * Function: setUnion
+ * ----------------------------------
+ * Summary: Adds every element of other to sp, walking other's leaves in order. The union of a set with
+ * itself is the set, so there is nothing to do (and other's leaves would split under us if we tried).
+ * Runtime: O(m logn)
+ */
+void setUnion(SET *sp, SET *other){
+	assert(sp!=NULL && other!=NULL);
+	struct node *np;
+	int i;
+
+	if (sp == other)
+		return;
+	for (np = other->first; np != NULL; np = np->next){
+		for (i = 0; i < np->count; i++){
+			addElement(sp, np->keys[i]);
+		}
+	}
+}
+
+/*
+ * Function: setIntersection
+ * ----------------------------------
+ * Summary: Removes the elements of sp that are not in other. We cannot remove while walking the leaves
+ * (a removal can merge them), so the doomed elements are collected first. A set intersected with itself
+ * keeps everything.
+ * Runtime: O(n logm + n logn)
+ */
+void setIntersection(SET *sp, SET *other){
+	assert(sp!=NULL && other!=NULL);
+	char **doomed;
+	struct node *np;
+	int i, n = 0;
+
+	if (sp == other)
+		return;
+	doomed = malloc(sizeof(char*)*sp->count);
+	assert(doomed!=NULL);
+	for (np = sp->first; np != NULL; np = np->next){
+		for (i = 0; i < np->count; i++){
+			if (findElement(other, np->keys[i]) == NULL)
+				doomed[n++] = np->keys[i];
+		}
+	}
+	for (i = 0; i < n; i++){
+		removeElement(sp, doomed[i]);					// the string is not looked at again once it is freed
+	}
+	free(doomed);
+}
+
+/*
+ * Function: setDifference
+ * ----------------------------------
+ * Summary: Removes the elements of sp that are in other, walking other's leaves in order. If they are
+ * the same set, everything goes, so we free the tree and start over with an empty leaf rather than walk
+ * leaves that the removals are merging.
+ * Runtime: O(m logn)
+ */
+void setDifference(SET *sp, SET *other){
+	assert(sp!=NULL && other!=NULL);
+	struct node *np;
+	int i;
+
+	if (sp == other){
+		destroyNode(sp->root);
+		sp->count = 0;
+		sp->root = sp->first = createNode(true);
+		return;
+	}
+	for (np = other->first; np != NULL; np = np->next){
+		for (i = 0; i < np->count; i++){
+			removeElement(sp, np->keys[i]);
+		}
+	}
+}
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor at the start of the leftmost leaf so nextElement can walk the set in order
+ * and in place, without the copies getElements makes. The set must not change while it is being walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->node = sp->first;
+	cp->index = 0;
+	cp->prefix = NULL;
+}
+
+/*
+ * Function: seekElement
+ * ----------------------------------
+ * Summary: Positions a cursor at the first element that is not less than elt (a lower bound) by walking
+ * down to its leaf. If every key in that leaf is smaller, nextElement moves on to the next leaf.
+ * Runtime: O(logn)
+ */
+void seekElement(SET *sp, CURSOR *cp, char *elt){
+	assert(elt!=NULL);
+	bool found;
+
+	beginElements(sp, cp);
+	cp->node = findLeaf(sp, elt);
+	cp->index = search(cp->node, elt, &found);
+	if (found)
+		cp->index--;
+}
+
+/*
+ * Function: prefixElements
+ * ----------------------------------
+ * Summary: Positions a cursor at the first element starting with prefix. The elements with a given
+ * prefix are all next to each other, so nextElement can stop at the first one that does not match.
+ * Runtime: O(logn)
+ */
+void prefixElements(SET *sp, CURSOR *cp, char *prefix){
+	seekElement(sp, cp, prefix);
+	cp->prefix = prefix;
+	cp->length = strlen(prefix);
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the next element in order, or NULL at the end of the set or of the prefix range,
+ * following the links between the leaves.
+ * Runtime: O(1)
+ */
+char *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	struct node *np = cp->node;
+
+	while (np != NULL && cp->index >= np->count){			// this leaf is done (leaves may be empty)
+		np = cp->node = np->next;
+		cp->index = 0;
+	}
+	if (np == NULL)
+		return NULL;
+	if (cp->prefix != NULL && strncmp(np->keys[cp->index], cp->prefix, cp->length) != 0)
+		return NULL;
+	return np->keys[cp->index++];
+}
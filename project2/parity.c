@@ -16,6 +16,7 @@
 # include <stdlib.h>
 # include <string.h>
 # include "set.h"
+# include "words.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -31,7 +32,7 @@
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
+    WORDS *wp;
     char buffer[BUFSIZ];
     SET *odd;
     int words;
@@ -44,29 +45,26 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
 
 
-    /* Insert or delete words to compute their parity. */
+    /* Insert or delete words to compute their parity, with one search
+       for each. */
 
     words = 0;
     odd = createSet(MAX_SIZE);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
+    while (readWord(wp, buffer, BUFSIZ) == 1) {
         words ++;
-
-        if (findElement(odd, buffer))
-            removeElement(odd, buffer);
-        else
-            addElement(odd, buffer);
+        toggleElement(odd, buffer);
     }
 
     printf("%d total words\n", words);
     printf("%d words occur an odd number of times\n", numElements(odd));
-    fclose(fp);
+    closeWords(wp);
 
     destroySet(odd);
     exit(EXIT_SUCCESS);
@@ -11,8 +11,19 @@
 # ifndef SET_H
 # define SET_H
 
+# include <stdbool.h>
+
 typedef struct set SET;
 
+typedef struct cursor {
+    SET *set;
+    void *node;
+    int index;
+    char *low;
+    char *prefix;
+    int length;
+} CURSOR;
+
 SET *createSet(int maxElts);
 
 void destroySet(SET *sp);
@@ -21,10 +32,28 @@ int numElements(SET *sp);
 
 void addElement(SET *sp, char *elt);
 
+void addElements(SET *sp, char **elts, int n);
+
 void removeElement(SET *sp, char *elt);
 
+bool toggleElement(SET *sp, char *elt);
+
 char *findElement(SET *sp, char *elt);
 
 char **getElements(SET *sp);
 
+void setUnion(SET *sp, SET *other);
+
+void setIntersection(SET *sp, SET *other);
+
+void setDifference(SET *sp, SET *other);
+
+void beginElements(SET *sp, CURSOR *cp);
+
+void seekElement(SET *sp, CURSOR *cp, char *elt);
+
+void prefixElements(SET *sp, CURSOR *cp, char *prefix);
+
+char *nextElement(CURSOR *cp);
+
 # endif /* SET_H */
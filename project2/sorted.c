@@ -3,6 +3,8 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include "set.h"
+#define EYTZINGER_MIN 256
 
 /*
  * This file defines the struct called set (specifically an sorted set) and implements its 
@@ -16,11 +18,60 @@ struct set
 	int count;	/*number of elements*/
 	int length; /*length of array */
 	char **data; /*array of strings */
+	unsigned long long *prefixes; /*first 8 bytes of each string as a big-endian integer */
+	int lookups; /*finds since the set last changed */
+	bool ordered; /*whether the eytzinger copy below is up to date */
+	unsigned long long *eprefixes; /*prefixes in eytzinger (breadth first) order, 1-based */
+	char **edata; /*strings in the same order */
 };
 typedef struct set SET;
 
 static int search(SET *sp, char *elt, bool *found);		// prototyping the search function
 
+/*
+ * Function: prefixOf
+ * -------------------------------
+ * Summary: Packs the first 8 bytes of a string into an integer, first byte most significant and padded
+ * with zeros. Comparing two prefixes as integers then gives the same order as strcmp on those bytes,
+ * so most comparisons never have to follow the pointer to the string itself.
+ * Runtime: O(1)
+ */
+static unsigned long long prefixOf(char *s){
+	unsigned long long prefix = 0;
+	int i;
+
+	for (i = 0; i < 8 && s[i] != '\0'; i++){
+		prefix |= (unsigned long long) (unsigned char) s[i] << (56 - 8*i);
+	}
+	return prefix;
+}
+
+/*
+ * Function: compare
+ * -------------------------------
+ * Summary: Compares elt (whose prefix is given) with the string s as in strcmp, using the prefixes first.
+ * If the prefixes are equal and the last byte of the prefix is zero, both strings ended within those 8
+ * bytes so they are equal; otherwise strcmp only has to look at what comes after them.
+ * Runtime: O(1) unless the first 8 bytes match
+ */
+static inline int compare(char *elt, unsigned long long prefix, char *s, unsigned long long sprefix){
+	if (prefix != sprefix)
+		return prefix < sprefix ? -1 : 1;
+	if ((prefix & 0xFF) == 0)
+		return 0;
+	return strcmp(elt + 8, s + 8);
+}
+
+/*
+ * Function: compareStrings
+ * -------------------------------
+ * Summary: strcmp for qsort, which hands us pointers to the array elements rather than the elements.
+ * Runtime: O(1)
+ */
+static int compareStrings(const void *a, const void *b){
+	return strcmp(*(char **)a, *(char **)b);
+}
+
 /*
  * Function: *createSet
  * -------------------------------
@@ -37,7 +88,12 @@ SET *createSet(int maxElts){
 	sp->count = 0;								// this count element keeps track of the number of elements currently in the set
 	sp->length=maxElts;							// this is the length of the array
 	sp->data = malloc(sizeof(char*)*maxElts);	// this is an character array where the actual data is stored
-	assert(sp->data!=NULL);
+	sp->prefixes = malloc(sizeof(unsigned long long)*maxElts);
+	assert(sp->data!=NULL && sp->prefixes!=NULL);
+	sp->lookups = 0;
+	sp->ordered = false;
+	sp->eprefixes = NULL;
+	sp->edata = NULL;
 	return sp;
 }
 
@@ -56,6 +112,9 @@ void destroySet(SET *sp){
 		free(sp->data[i]);
 	}
 	free(sp->data);						// we then free the array
+	free(sp->prefixes);
+	free(sp->eprefixes);
+	free(sp->edata);
 	free(sp);							// finally we free the set
 }
 
@@ -75,17 +134,20 @@ int numElements(SET *sp){
  * ------------------------------------
  * Summary: This search function performs a binary search. We set bounds called, low, mid, and hi. 
  * diff will return an integer lexicographically comparing the strings. We use this to change our hi or 
- * low bounds depending on whether the first word comes before or after the second.
+ * low bounds depending on whether the first word comes before or after the second. The comparisons are
+ * done on the prefixes array first, which sits next to the other probes in memory, so we only touch the
+ * strings themselves when their first 8 bytes match.
  * Runtime: O(logn)
  */
 int search (SET *sp, char *elt, bool *found) {
 	int lo, hi, mid, diff;		// declare variables
+	unsigned long long prefix = prefixOf(elt);
 
 	lo = 0;
 	hi=sp->count-1;				// defining our lower and upper bounds (on one side of each array)
 	while (lo<=hi) {
 		mid = (lo + hi)/2;
-		diff = strcmp(elt,sp->data[mid]);
+		diff = compare(elt,prefix,sp->data[mid],sp->prefixes[mid]);
 		if(diff < 0) {			// if the word being searched for comes before the word in the array, we change our hi bound, so we only consider the first half
 			hi = mid - 1;
 		}
@@ -118,10 +180,91 @@ void addElement(SET *sp, char *elt){
 		for (int i = sp->count; i > index; i--)
 		{
 			sp->data[i]=sp->data[i-1];
+			sp->prefixes[i]=sp->prefixes[i-1];
 		}
 		sp->data[index]=strdup(elt);				// now that everything is shifted, we assign that empty spot in the array to a duplicated string
+		sp->prefixes[index]=prefixOf(elt);
 		sp->count++;
+		sp->ordered = false;
+		sp->lookups = 0;
+	}
+}
+
+/*
+ * Function: merge
+ * -------------------------------------
+ * Summary: Merges m sorted, distinct strings into the array in a single pass. The merge runs from the
+ * back, so every existing element moves at most once and nothing is overwritten before it is read;
+ * strings already in the set are skipped, which leaves a gap that one memmove closes at the end. The
+ * array grows if the strings will not fit.
+ * Runtime: O(m + n)
+ */
+static void merge(SET *sp, char **batch, int m){
+	int i, j, k, diff;
+
+	if (sp->count + m > sp->length){						// make room for the case where everything is new
+		sp->length = sp->count + m > 2*sp->length ? sp->count + m : 2*sp->length;
+		sp->data = realloc(sp->data, sizeof(char*)*sp->length);
+		sp->prefixes = realloc(sp->prefixes, sizeof(unsigned long long)*sp->length);
+		assert(sp->data!=NULL && sp->prefixes!=NULL);
+	}
+
+	i = sp->count - 1;										// last existing element
+	j = m - 1;												// last batch element
+	k = sp->count + m - 1;									// where the largest remaining element goes
+	while (j >= 0) {
+		diff = i >= 0 ? strcmp(sp->data[i], batch[j]) : -1;
+		if (diff > 0) {										// the existing element is larger, move it up
+			sp->prefixes[k] = sp->prefixes[i];
+			sp->data[k--] = sp->data[i--];
+		}
+		else if (diff < 0) {								// the batch element is larger (and new)
+			sp->prefixes[k] = prefixOf(batch[j]);
+			sp->data[k--] = strdup(batch[j--]);
+		}
+		else {												// already in the set, skip it
+			j--;
+		}
+	}
+
+	// data[0..i] never moved and the merged part starts at k+1, so close the gap left by the skipped duplicates
+	if (k > i) {
+		memmove(&sp->data[i+1], &sp->data[k+1], sizeof(char*)*(sp->count + m - 1 - k));
+		memmove(&sp->prefixes[i+1], &sp->prefixes[k+1], sizeof(unsigned long long)*(sp->count + m - 1 - k));
 	}
+	sp->count += m - (k - i);
+	sp->ordered = false;
+	sp->lookups = 0;
+}
+
+/*
+ * Function: addElements
+ * -------------------------------------
+ * Summary: Adds a batch of n elements at once. Calling addElement n times shifts the tail of the array
+ * for every insert, so instead we sort a copy of the batch, drop its duplicates, and merge it into the
+ * array in a single pass.
+ * Runtime: O(m log m + n) for a batch of m elements
+ */
+void addElements(SET *sp, char **elts, int n){
+	assert(sp!=NULL && elts!=NULL);
+	char **batch;
+	int i, m;
+
+	if (n == 0)
+		return;
+
+	batch = malloc(sizeof(char*)*n);						// sort a copy so the caller's array is left alone
+	assert(batch!=NULL);
+	memcpy(batch, elts, sizeof(char*)*n);
+	qsort(batch, n, sizeof(char*), compareStrings);
+
+	for (i = 1, m = 1; i < n; i++){							// remove the duplicates within the batch
+		if (strcmp(batch[i], batch[m-1]) != 0)
+			batch[m++] = batch[i];
+	}
+
+	merge(sp, batch, m);
+	free(batch);
 }
 
 /*
@@ -139,22 +282,110 @@ void removeElement(SET *sp, char *elt){
 		free(sp->data[index]);						// free the memory at index essentially deleting it
 		for (int i = index+1; i < sp->count;i++){	// shift everything above the index one to the left
 			sp->data[i-1]=sp->data[i];
+			sp->prefixes[i-1]=sp->prefixes[i];
 		}
 		sp->count--;
+		sp->ordered = false;
+		sp->lookups = 0;
+	}
+}
+
+/*
+ * Function: toggleElement
+ * ------------------------------------
+ * Summary: Searches (using binary search) for the element once. If found, it is removed as in removeElement,
+ * and otherwise it is inserted where the search stopped, as in addElement. Either way only the elements
+ * above that index move, with one memmove. Returns whether the element was added.
+ * Runtime: O(n)
+ */
+bool toggleElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool searched;
+	int index = search(sp, elt, &searched);
+
+	if(searched==true) {
+		free(sp->data[index]);
+		memmove(&sp->data[index], &sp->data[index+1], sizeof(char*)*(sp->count-index-1));
+		memmove(&sp->prefixes[index], &sp->prefixes[index+1], sizeof(unsigned long long)*(sp->count-index-1));
+		sp->count--;
+	}
+	else {
+		memmove(&sp->data[index+1], &sp->data[index], sizeof(char*)*(sp->count-index));
+		memmove(&sp->prefixes[index+1], &sp->prefixes[index], sizeof(unsigned long long)*(sp->count-index));
+		sp->data[index]=strdup(elt);
+		sp->prefixes[index]=prefixOf(elt);
+		sp->count++;
 	}
+	sp->ordered = false;
+	sp->lookups = 0;
+	return !searched;
+}
+
+/*
+ * Function: layout
+ * -------------------------------------
+ * Summary: Fills in the eytzinger copy of the array: node k has its children at 2k and 2k+1, so an
+ * in-order walk of that implicit tree visits the elements in sorted order. Returns the index of the next
+ * sorted element to place.
+ * Runtime: O(n)
+ */
+static int layout(SET *sp, int i, int k){
+	if (k <= sp->count) {
+		i = layout(sp, i, 2*k);
+		sp->eprefixes[k] = sp->prefixes[i];
+		sp->edata[k] = sp->data[i++];
+		i = layout(sp, i, 2*k+1);
+	}
+	return i;
+}
+
+/*
+ * Function: searchOrdered
+ * -------------------------------------
+ * Summary: Binary search over the eytzinger copy. The top of the tree is packed into the first few cache
+ * lines and the path down is just k = 2k or 2k+1, so we can prefetch the line holding the
+ * great-grandchildren of k while we compare against k. At the end, k with its trailing ones (the right
+ * turns after the last left turn) shifted off is the first element not less than elt.
+ * Runtime: O(logn)
+ */
+static bool searchOrdered(SET *sp, char *elt){
+	unsigned long long prefix = prefixOf(elt);
+	unsigned k = 1;
+
+	while (k <= (unsigned) sp->count) {
+		__builtin_prefetch(&sp->eprefixes[8*k]);
+		k = 2*k + (compare(elt, prefix, sp->edata[k], sp->eprefixes[k]) > 0);
+	}
+	k >>= __builtin_ffs(~k);
+	return k != 0 && compare(elt, prefix, sp->edata[k], sp->eprefixes[k]) == 0;
 }
 
 /*
  * Function: *findElement
  * -------------------------------------
  * Summary: Uses the search function. If search is true, then we have found the element and return the 
- * element. Otherwise, return NULL.
+ * element. Otherwise, return NULL. Once a large set has seen as many finds as it has elements without
+ * changing, we treat it as read-mostly and switch to an eytzinger copy of the array, which is friendlier
+ * to the cache; any change to the set throws that copy away again. Building the copy is O(n), so waiting
+ * for n finds keeps it O(1) amortized.
  * Runtime: O(logn)
  */
 char *findElement(SET *sp, char *elt){
 	assert(sp!=NULL && elt!=NULL);
 	bool searched;
-	int index = search(sp, elt, &searched);
+
+	if (!sp->ordered && sp->count >= EYTZINGER_MIN && ++sp->lookups >= sp->count){
+		sp->eprefixes = realloc(sp->eprefixes, sizeof(unsigned long long)*(sp->count+1));
+		sp->edata = realloc(sp->edata, sizeof(char*)*(sp->count+1));
+		assert(sp->eprefixes!=NULL && sp->edata!=NULL);
+		layout(sp, 0, 1);
+		sp->ordered = true;
+	}
+
+	if (sp->ordered)
+		searched = searchOrdered(sp, elt);
+	else
+		search(sp, elt, &searched);
 	if (searched==true){
 		return elt;
 	}
@@ -177,3 +408,141 @@ char **getElements(SET *sp){
 	}
 	return arr;
 }
+
+/*
+ * Function: setUnion
+ * ----------------------------------
+ * Summary: Adds every element of other to sp. Both arrays are already sorted and distinct, so this is a
+ * single merge. The union of a set with itself is the set, and merging it into itself would read the
+ * array while it is being reallocated, so that case does nothing.
+ * Runtime: O(n + m)
+ */
+void setUnion(SET *sp, SET *other){
+	assert(sp!=NULL && other!=NULL);
+	if (sp == other)
+		return;
+	merge(sp, other->data, other->count);
+}
+
+/*
+ * Function: filter
+ * ----------------------------------
+ * Summary: Walks both arrays side by side (as in a merge) and keeps the elements of sp whose membership
+ * in other equals keep, sliding the kept ones down over the ones we free. Every element of a set is in
+ * itself, so when other is sp we keep all of them or free all of them without comparing any (comparing
+ * would read strings we had just freed).
+ * Runtime: O(n + m)
+ */
+static void filter(SET *sp, SET *other, bool keep){
+	int i, j = 0, k = 0, diff;
+
+	if (sp == other){
+		if (!keep){
+			for (i = 0; i < sp->count; i++){
+				free(sp->data[i]);
+			}
+			sp->count = 0;
+			sp->ordered = false;
+			sp->lookups = 0;
+		}
+		return;
+	}
+	for (i = 0; i < sp->count; i++){
+		diff = -1;
+		while (j < other->count && (diff = compare(sp->data[i], sp->prefixes[i], other->data[j], other->prefixes[j])) > 0){
+			j++;											// skip the elements of other that are smaller
+		}
+		if ((j < other->count && diff == 0) == keep){
+			sp->prefixes[k] = sp->prefixes[i];
+			sp->data[k++] = sp->data[i];
+		}
+		else {
+			free(sp->data[i]);
+		}
+	}
+	sp->count = k;
+	sp->ordered = false;
+	sp->lookups = 0;
+}
+
+/*
+ * Function: setIntersection
+ * ----------------------------------
+ * Summary: Removes the elements of sp that are not in other, in one pass over both arrays.
+ * Runtime: O(n + m)
+ */
+void setIntersection(SET *sp, SET *other){
+	assert(sp!=NULL && other!=NULL);
+	filter(sp, other, true);
+}
+
+/*
+ * Function: setDifference
+ * ----------------------------------
+ * Summary: Removes the elements of sp that are in other, in one pass over both arrays. Removing them
+ * one at a time would shift the array for each of them.
+ * Runtime: O(n + m)
+ */
+void setDifference(SET *sp, SET *other){
+	assert(sp!=NULL && other!=NULL);
+	filter(sp, other, false);
+}
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor before the first element so nextElement can walk the set in order and in
+ * place, without the copies getElements makes. The set must not change while it is being walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->index = 0;
+	cp->prefix = NULL;
+}
+
+/*
+ * Function: seekElement
+ * ----------------------------------
+ * Summary: Positions a cursor at the first element that is not less than elt (a lower bound), which is
+ * exactly the index search returns.
+ * Runtime: O(logn)
+ */
+void seekElement(SET *sp, CURSOR *cp, char *elt){
+	assert(elt!=NULL);
+	bool found;
+
+	beginElements(sp, cp);
+	cp->index = search(sp, elt, &found);
+}
+
+/*
+ * Function: prefixElements
+ * ----------------------------------
+ * Summary: Positions a cursor at the first element starting with prefix. The elements with a given
+ * prefix are all next to each other, so nextElement can stop at the first one that does not match.
+ * Runtime: O(logn)
+ */
+void prefixElements(SET *sp, CURSOR *cp, char *prefix){
+	seekElement(sp, cp, prefix);
+	cp->prefix = prefix;
+	cp->length = strlen(prefix);
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the next element in order, or NULL at the end of the set or of the prefix range.
+ * Runtime: O(1)
+ */
+char *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	SET *sp = cp->set;
+
+	if (cp->index >= sp->count)
+		return NULL;
+	if (cp->prefix != NULL && strncmp(sp->data[cp->index], cp->prefix, cp->length) != 0)
+		return NULL;
+	return sp->data[cp->index++];
+}
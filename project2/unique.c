@@ -12,13 +12,19 @@
  *              total words in the set are printed.  If the second file is
  *              given then all words in the second file are deleted from
  *              the set and the count printed.
+ *
+ *              With -m, the words in the second file are loaded into a
+ *              set of their own instead and subtracted all at once with
+ *              setDifference, which on the sorted set is a single merge.
  */
 
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
 # include <stdbool.h>
+# include <assert.h>
 # include "set.h"
+# include "words.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -26,6 +32,51 @@
 # define MAX_SIZE 18000
 
 
+/* The number of words, and bytes of words, to insert at a time. */
+
+# define BATCH_SIZE 65536
+# define BLOCK_SIZE (1 << 20)
+
+
+/*
+ * Function:    insertWords
+ *
+ * Description: Insert all words read from WP into the set SP and return
+ *              the number of words read.  The words are collected into
+ *              batches so the set can sort and merge each batch in one
+ *              pass.
+ */
+
+static int insertWords(SET *sp, WORDS *wp)
+{
+    char **batch, *block;
+    int n, words;
+    size_t used;
+
+
+    batch = malloc(sizeof(char *) * BATCH_SIZE);
+    block = malloc(BLOCK_SIZE);
+    assert(batch != NULL && block != NULL);
+    words = n = used = 0;
+
+    while (readWord(wp, block + used, BUFSIZ) == 1) {
+        words ++;
+        batch[n ++] = block + used;
+        used += strlen(block + used) + 1;
+
+        if (n == BATCH_SIZE || used + BUFSIZ > BLOCK_SIZE) {
+            addElements(sp, batch, n);
+            n = used = 0;
+        }
+    }
+
+    addElements(sp, batch, n);
+    free(block);
+    free(batch);
+    return words;
+}
+
+
 /*
  * Function:    main
  *
@@ -34,17 +85,22 @@
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ], **elts;
-    SET *unique;
+    WORDS *wp;
+    char buffer[BUFSIZ], *word;
+    SET *unique, *stop;
+    CURSOR cursor;
     int i, words;
-    bool lflag = false;
+    bool lflag = false, mflag = false;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
+    while (argc > 1 && (strcmp(argv[1], "-l") == 0 || strcmp(argv[1], "-m") == 0)) {
+	if (strcmp(argv[1], "-l") == 0)
+	    lflag = true;
+	else
+	    mflag = true;
+
 	argc --;
 
 	for (i = 1; i < argc; i ++)
@@ -52,11 +108,11 @@ int main(int argc, char *argv[])
     }
 
     if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+        fprintf(stderr, "usage: %s [-l] [-m] file1 [file2]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
@@ -64,15 +120,9 @@ int main(int argc, char *argv[])
 
     /* Insert all words into the set. */
 
-    words = 0;
     unique = createSet(MAX_SIZE);
-
-    while (fscanf(fp, "%s", buffer) == 1) {
-        words ++;
-        addElement(unique, buffer);
-    }
-
-    fclose(fp);
+    words = insertWords(unique, wp);
+    closeWords(wp);
 
     if (!lflag) {
 	printf("%d total words\n", words);
@@ -83,18 +133,26 @@ int main(int argc, char *argv[])
     /* Try to open the second file. */
 
     if (argc == 3) {
-        if ((fp = fopen(argv[2], "r")) == NULL) {
+        if ((wp = openWords(argv[2])) == NULL) {
             fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[2]);
             exit(EXIT_FAILURE);
         }
 
 
-        /* Delete all words in the second file. */
+        /* Delete all words in the second file, either one at a time or
+           by loading them into a set of their own and subtracting it. */
 
-        while (fscanf(fp, "%s", buffer) == 1)
-            removeElement(unique, buffer);
+        if (mflag) {
+            stop = createSet(MAX_SIZE);
+            insertWords(stop, wp);
+            setDifference(unique, stop);
+            destroySet(stop);
+        } else {
+            while (readWord(wp, buffer, BUFSIZ) == 1)
+                removeElement(unique, buffer);
+        }
 
-	fclose(fp);
+	closeWords(wp);
 
 	if (!lflag)
 	    printf("%d remaining words\n", numElements(unique));
@@ -104,12 +162,10 @@ int main(int argc, char *argv[])
     /* Print the list of words if desired. */
 
     if (lflag) {
-	elts = getElements(unique);
-
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
+	beginElements(unique, &cursor);
 
-	free(elts);
+	while ((word = nextElement(&cursor)) != NULL)
+	    printf("%s\n", word);
     }
 
     destroySet(unique);
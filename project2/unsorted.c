@@ -2,6 +2,10 @@
 #include <string.h>
 #include <assert.h>
 #include <stdio.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "unsorted.h"
 
 /*
  * This file defines the struct called set (specifically an unsorted set) and implements its 
@@ -15,11 +19,34 @@ struct set
 	int count;	/*number of elements*/
 	int length; /*length of array */
 	char **data; /*array of strings */
+	unsigned char *prints; /*8-bit hash of each string */
+	unsigned char *lengths; /*length of each string, 255 if longer */
+	int policy; /*what to do with an element when a search finds it */
+	long searches; /*number of searches */
+	long scanned; /*number of elements looked at by those searches */
 };
 typedef struct set SET;
 
 static int search(SET *sp, char *elt);		// prototyping the search function
 
+/*
+ * Function: fingerprint
+ * -------------------------------
+ * Summary: Hashes a string (FNV-1a) and returns the top 8 bits of the hash as its fingerprint. The
+ * length comes out of the same loop, saturated to 255 so it fits in a byte.
+ * Runtime: O(1)
+ */
+static unsigned char fingerprint(char *s, unsigned char *lenp){
+	unsigned hash = 2166136261u;
+	int i;
+
+	for (i = 0; s[i] != '\0'; i++){
+		hash = (hash ^ (unsigned char) s[i]) * 16777619u;
+	}
+	*lenp = i < 255 ? i : 255;
+	return hash >> 24;
+}
+
 /*
  * Function: *createSet
  * -------------------------------
@@ -36,7 +63,11 @@ SET *createSet(int maxElts){
 	sp->count = 0;								// this count element keeps track of the number of elements currently in the set
 	sp->length=maxElts;							// this is the length of the array
 	sp->data = malloc(sizeof(char*)*maxElts);	// this is an character array where the actual data is stored
-	assert(sp->data!=NULL);
+	sp->prints = malloc(maxElts+16);			// search reads 16 bytes at a time, so leave room past the end
+	sp->lengths = malloc(maxElts+16);
+	assert(sp->data!=NULL && sp->prints!=NULL && sp->lengths!=NULL);
+	sp->policy = NO_POLICY;
+	sp->searches = sp->scanned = 0;
 	return sp;
 }
 
@@ -55,6 +86,8 @@ void destroySet(SET *sp){
 		free(sp->data[i]);
 	}
 	free(sp->data);				// we then free the array
+	free(sp->prints);
+	free(sp->lengths);
 	free(sp);					// finally we free the set
 }
 
@@ -69,6 +102,115 @@ int numElements(SET *sp){
 	return sp->count;
 }
 
+/*
+ * Function: setPolicy
+ * ----------------------------------
+ * Summary: Chooses what findElement and addElement do with an element they find: nothing (NO_POLICY),
+ * swap it with the one before it (TRANSPOSE), or move it to the front (MOVE_TO_FRONT). Word streams are
+ * skewed, so either way the popular words collect at the front where the scan reaches them first.
+ * Note that with a policy, a find changes the order and so cannot be mixed with walking a cursor.
+ * Runtime: O(1)
+ */
+void setPolicy(SET *sp, int policy){
+	assert(sp!=NULL && policy>=NO_POLICY && policy<=MOVE_TO_FRONT);
+	sp->policy = policy;
+}
+
+/*
+ * Function: averageScan
+ * ----------------------------------
+ * Summary: Returns the average number of elements each search has looked at (the position of the
+ * element if found, or every element if not), and starts counting again.
+ * Runtime: O(1)
+ */
+double averageScan(SET *sp){
+	assert(sp!=NULL);
+	double average = sp->searches>0 ? (double) sp->scanned/sp->searches : 0;
+
+	sp->searches = sp->scanned = 0;
+	return average;
+}
+
+/*
+ * Function: move
+ * ----------------------------------
+ * Summary: Moves the element at index from to index to (which must not be greater), shifting the ones
+ * in between up by one. All three arrays move together.
+ * Runtime: O(from - to)
+ */
+static void move(SET *sp, int from, int to){
+	char *elt = sp->data[from];
+	unsigned char print = sp->prints[from], length = sp->lengths[from];
+
+	memmove(&sp->data[to+1], &sp->data[to], sizeof(char*)*(from-to));
+	memmove(&sp->prints[to+1], &sp->prints[to], from-to);
+	memmove(&sp->lengths[to+1], &sp->lengths[to], from-to);
+	sp->data[to] = elt;
+	sp->prints[to] = print;
+	sp->lengths[to] = length;
+}
+
+/*
+ * Function: promote
+ * ----------------------------------
+ * Summary: Applies the set's policy to the element a search just found at index.
+ * Runtime: O(1) for TRANSPOSE, O(index) for MOVE_TO_FRONT
+ */
+static void promote(SET *sp, int index){
+	if(sp->policy==TRANSPOSE && index>0){
+		move(sp, index, index-1);
+	}
+	else if(sp->policy==MOVE_TO_FRONT && index>0){
+		move(sp, index, 0);
+	}
+}
+
+/*
+ * Function: grow
+ * ----------------------------------
+ * Summary: Doubles the length of the three arrays (as merge does in sorted.c), keeping the room search
+ * needs past the end of the fingerprints and lengths.
+ * Runtime: O(n)
+ */
+static void grow(SET *sp){
+	sp->length = sp->length > 0 ? 2*sp->length : 16;
+	sp->data = realloc(sp->data, sizeof(char*)*sp->length);
+	sp->prints = realloc(sp->prints, sp->length+16);
+	sp->lengths = realloc(sp->lengths, sp->length+16);
+	assert(sp->data!=NULL && sp->prints!=NULL && sp->lengths!=NULL);
+}
+
+/*
+ * Function: append
+ * ----------------------------------
+ * Summary: Adds a copy of an element that is not in the set to the end of the array, which grows if it
+ * is full.
+ * Runtime: O(1) amortized
+ */
+static void append(SET *sp, char *elt){
+	if(sp->count==sp->length){
+		grow(sp);
+	}
+	sp->data[sp->count]=strdup(elt);
+	sp->prints[sp->count]=fingerprint(elt, &sp->lengths[sp->count]);
+	sp->count++;
+}
+
+/*
+ * Function: removeAt
+ * ----------------------------------
+ * Summary: Frees the element at index and places the last element in its place.
+ * Runtime: O(1)
+ */
+static void removeAt(SET *sp, int index){
+	free(sp->data[index]);					// Free the memory at that index
+	sp->data[index]=sp->data[sp->count-1];	// Place the current last element into that slot
+	sp->prints[index]=sp->prints[sp->count-1];
+	sp->lengths[index]=sp->lengths[sp->count-1];
+	sp->data[sp->count-1]=NULL;
+	sp->count--;
+}
+
 /*
  * Function: addElement
  * ----------------------------------
@@ -80,9 +222,28 @@ void addElement(SET *sp, char *elt){
 	assert(sp!=NULL && elt!=NULL);
 
 	// Searches through array first
-	if(search(sp, elt)==-1){
-		sp->data[sp->count]=strdup(elt);		// if found, then we add element to end of the array
-		sp->count++;
+	int index = search(sp, elt);
+	if(index==-1){
+		append(sp, elt);						// if not found, then we add element to end of the array
+	}
+	else {
+		promote(sp, index);
+	}
+}
+
+/*
+ * Function: addElements
+ * ----------------------------------
+ * Summary: Adds a batch of elements. There is no order to take advantage of here, so this simply
+ * calls addElement on each of them.
+ * Runtime: O(n*m)
+ */
+void addElements(SET *sp, char **elts, int n){
+	assert(sp!=NULL && elts!=NULL);
+	int i;
+
+	for(i=0;i<n;i++){
+		addElement(sp, elts[i]);
 	}
 }
 
@@ -98,13 +259,29 @@ void removeElement(SET *sp, char *elt){
 	int index = search(sp,elt);					// Searches through array first
 
 	if(index!=-1){
-		free(sp->data[index]);					// Free the memory at that index
-		sp->data[index]=sp->data[sp->count-1];	// Place the current last element into that slot
-		sp->data[sp->count-1]=NULL;
-		sp->count--;
+		removeAt(sp, index);
 	}
 }
 
+/*
+ * Function: toggleElement
+ * ----------------------------------
+ * Summary: Removes the element if it is in the set and adds it if not, with a single scan. Returns whether
+ * it was added. No policy is applied, since a found element is removed anyway.
+ * Runtime: O(n)
+ */
+bool toggleElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	int index = search(sp,elt);
+
+	if(index!=-1){
+		removeAt(sp, index);
+		return false;
+	}
+	append(sp, elt);
+	return true;
+}
+
 /*
  * Function: *findElement
  * ----------------------------------
@@ -114,13 +291,11 @@ void removeElement(SET *sp, char *elt){
  */
 char *findElement(SET *sp, char *elt){
 	assert(sp!=NULL && elt!=NULL);
-	int i;
+	int index = search(sp,elt);
 
-	// for loop to iterate through the array
-	for(i=0;i<sp->count;i++){
-		if(strcmp(sp->data[i],elt)==0){		// use strcmp to compare the string in that index to elt
-			return elt;
-		}
+	if(index!=-1){
+		promote(sp, index);
+		return elt;
 	}
 	return NULL;
 }
@@ -145,18 +320,171 @@ char **getElements(SET *sp){
  * Function: search
  * ----------------------------------
  * Summary: search linearly searches through the set and returns the index of the specified element if 
- * found. It not found, it will return -1
+ * found. It not found, it will return -1. Rather than calling strcmp on every element, we scan the
+ * fingerprint and length arrays, 16 entries at a time with SSE2, and only call strcmp on the entries
+ * where both match; with 8-bit fingerprints that is about one in 256 of the others.
  * Runtime: O(n)
  */
 static int search(SET *sp, char *elt){
 	assert(sp!=NULL && elt!=NULL);
+	unsigned char print, length;
 	int i;
 
+	print = fingerprint(elt, &length);
+#ifdef __SSE2__
+	__m128i prints = _mm_set1_epi8(print), lengths = _mm_set1_epi8(length);
+	unsigned mask;
+
+	for(i=0;i<sp->count;i+=16){
+		mask = _mm_movemask_epi8(_mm_and_si128(
+			_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) &sp->prints[i]), prints),
+			_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) &sp->lengths[i]), lengths)));
+		if(sp->count-i < 16){					// ignore whatever is past the last element
+			mask &= (1u << (sp->count-i)) - 1;
+		}
+		while(mask!=0){							// compare the string at each candidate to element
+			if(strcmp(sp->data[i+__builtin_ctz(mask)],elt)==0){
+				i += __builtin_ctz(mask);
+				sp->searches++;
+				sp->scanned += i+1;
+				return i;
+			}
+			mask &= mask-1;
+		}
+	}
+#else
 	// for loop to iterate through the array
 	for(i=0;i<sp->count;i++){
-		if(strcmp(sp->data[i],elt)==0){		// compare the string at the index to element
+		if(sp->prints[i]==print && sp->lengths[i]==length && strcmp(sp->data[i],elt)==0){
+			sp->searches++;
+			sp->scanned += i+1;
 			return i;
 		}
 	}
+#endif
+	sp->searches++;
+	sp->scanned += sp->count;
 	return -1;								// at this point, element is not found so -1 is returned
 }
+
+/*
+ * Function: setUnion
+ * ----------------------------------
+ * Summary: Adds every element of other to sp. The union of a set with itself is the set, so there is
+ * nothing to do (and the array we would be reading from could move as it grows).
+ * Runtime: O(n*m)
+ */
+void setUnion(SET *sp, SET *other){
+	assert(sp!=NULL && other!=NULL);
+	if(sp==other){
+		return;
+	}
+	addElements(sp, other->data, other->count);
+}
+
+/*
+ * Function: setIntersection
+ * ----------------------------------
+ * Summary: Removes the elements of sp that are not in other, by index since we already know where they
+ * are. We go from the back since removing an element moves the last one into its place, which has already
+ * been checked. A set intersected with itself keeps everything.
+ * Runtime: O(n*m)
+ */
+void setIntersection(SET *sp, SET *other){
+	assert(sp!=NULL && other!=NULL);
+	int i;
+
+	if(sp==other){
+		return;
+	}
+	for (i = sp->count-1; i >= 0; i--){
+		if (search(other, sp->data[i]) == -1)
+			removeAt(sp, i);
+	}
+}
+
+/*
+ * Function: setDifference
+ * ----------------------------------
+ * Summary: Removes the elements of sp that are in other. If they are the same set, everything goes, so
+ * we free the elements directly instead of walking an array that the removals are changing.
+ * Runtime: O(n*m)
+ */
+void setDifference(SET *sp, SET *other){
+	assert(sp!=NULL && other!=NULL);
+	int i;
+
+	if(sp==other){
+		for (i = 0; i < sp->count; i++){
+			free(sp->data[i]);
+		}
+		sp->count = 0;
+		return;
+	}
+	for (i = 0; i < other->count; i++){
+		removeElement(sp, other->data[i]);
+	}
+}
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor before the first element so nextElement can walk the set in place,
+ * without the copies getElements makes. The set must not change while it is being walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->index = 0;
+	cp->low = NULL;
+	cp->prefix = NULL;
+}
+
+/*
+ * Function: seekElement
+ * ----------------------------------
+ * Summary: Like beginElements, but the cursor only returns the elements that are not less than elt.
+ * The set is not ordered, so they still come back in no particular order.
+ * Runtime: O(1)
+ */
+void seekElement(SET *sp, CURSOR *cp, char *elt){
+	assert(elt!=NULL);
+	beginElements(sp, cp);
+	cp->low = elt;
+}
+
+/*
+ * Function: prefixElements
+ * ----------------------------------
+ * Summary: Like beginElements, but the cursor only returns the elements that start with prefix.
+ * Runtime: O(1)
+ */
+void prefixElements(SET *sp, CURSOR *cp, char *prefix){
+	assert(prefix!=NULL);
+	beginElements(sp, cp);
+	cp->prefix = prefix;
+	cp->length = strlen(prefix);
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the next element that passes the cursor's filter, or NULL when there are none left.
+ * Runtime: O(n) in the worst case, O(1) amortized over a whole walk
+ */
+char *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	SET *sp = cp->set;
+	char *elt;
+
+	while (cp->index < sp->count){
+		elt = sp->data[cp->index++];
+		if (cp->low != NULL && strcmp(elt, cp->low) < 0)
+			continue;
+		if (cp->prefix != NULL && strncmp(elt, cp->prefix, cp->length) != 0)
+			continue;
+		return elt;
+	}
+	return NULL;
+}
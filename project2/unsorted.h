@@ -0,0 +1,23 @@
+/*
+ * File:        unsorted.h
+ *
+ * Description: This file contains the declarations for the functions
+ *              that only the unsorted set has, on top of those in set.h.
+ *              The unsorted set can reorder itself as it is searched so
+ *              that frequently found elements are found sooner.
+ */
+
+# ifndef UNSORTED_H
+# define UNSORTED_H
+
+# include "set.h"
+
+# define NO_POLICY 0
+# define TRANSPOSE 1
+# define MOVE_TO_FRONT 2
+
+void setPolicy(SET *sp, int policy);
+
+double averageScan(SET *sp);
+
+# endif /* UNSORTED_H */
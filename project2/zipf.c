@@ -0,0 +1,136 @@
+/*
+ * File:        zipf.c
+ *
+ * Description: This file contains a benchmark for the self-organizing
+ *              policies of the unsorted set.
+ *
+ *              The program loads a vocabulary into the set in random
+ *              order and then looks up a stream of words drawn from it
+ *              whose frequencies follow Zipf's law, as the words in
+ *              English text do.  This is done once for each policy, and
+ *              the average number of elements scanned per lookup and the
+ *              time taken are printed.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <math.h>
+# include <time.h>
+# include "unsorted.h"
+
+
+/* The defaults: vocabulary size, stream length, and Zipf exponent. */
+
+# define WORDS 10000
+# define STREAM 1000000
+# define EXPONENT 1.0
+
+
+/*
+ * Function:    sample
+ *
+ * Description: Return a rank drawn from the cumulative distribution CDF
+ *              of N ranks, by binary search.
+ */
+
+static int sample(double *cdf, int n)
+{
+    double u = drand48();
+    int lo = 0, hi = n - 1, mid;
+
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+
+        if (cdf[mid] < u)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    static char *names[] = {"none", "transpose", "move-to-front"};
+    char buffer[32];
+    double *cdf, total, exponent;
+    int i, j, n, stream, policy, *order;
+    clock_t start;
+    SET *sp;
+
+
+    /* Check usage and build the distribution. */
+
+    if (argc > 4) {
+        fprintf(stderr, "usage: %s [words [stream [exponent]]]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    n = argc > 1 ? atoi(argv[1]) : WORDS;
+    stream = argc > 2 ? atoi(argv[2]) : STREAM;
+    exponent = argc > 3 ? atof(argv[3]) : EXPONENT;
+
+    cdf = malloc(sizeof(double) * n);
+    total = 0;
+
+    for (i = 0; i < n; i ++) {
+        total += 1 / pow(i + 1, exponent);
+        cdf[i] = total;
+    }
+
+    for (i = 0; i < n; i ++)
+        cdf[i] /= total;
+
+
+    /* Shuffle the vocabulary so the popular words are not loaded first. */
+
+    order = malloc(sizeof(int) * n);
+    srand48(1);
+
+    for (i = 0; i < n; i ++) {
+        j = lrand48() % (i + 1);
+        order[i] = order[j];
+        order[j] = i;
+    }
+
+
+    /* Run the same stream through a set with each policy. */
+
+    printf("%d words, %d lookups, exponent %.2f\n", n, stream, exponent);
+
+    for (policy = NO_POLICY; policy <= MOVE_TO_FRONT; policy ++) {
+        sp = createSet(n);
+
+        for (i = 0; i < n; i ++) {
+            sprintf(buffer, "w%d", order[i]);
+            addElement(sp, buffer);
+        }
+
+        averageScan(sp);
+        setPolicy(sp, policy);
+        srand48(2);
+        start = clock();
+
+        for (i = 0; i < stream; i ++) {
+            sprintf(buffer, "w%d", sample(cdf, n));
+            findElement(sp, buffer);
+        }
+
+        printf("%-14s %8.1f scanned per lookup %8.3fs\n", names[policy],
+            averageScan(sp), (double) (clock() - start) / CLOCKS_PER_SEC);
+        destroySet(sp);
+    }
+
+    free(order);
+    free(cdf);
+    exit(EXIT_SUCCESS);
+}
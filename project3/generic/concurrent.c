@@ -0,0 +1,288 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "set.h"
+#define MAX_LOAD 50
+#define STRIPES 64
+
+/*
+ * This file implements the same set as table.c, but one that any number of threads can use at once
+ * (details are commented above each function). A slot holds NULL while it is EMPTY, a pointer to the
+ * DELETED marker after a remove, and otherwise the element. Lookups take no locks at all: they read the
+ * slots with acquire loads and stop at the first NULL. Adds and removes lock one of STRIPES mutexes,
+ * picked by the hash of the element, so two threads working on the same element take turns while those
+ * working on different ones mostly do not. An add claims its slot with a compare-and-swap, since an add
+ * of a different element under another stripe could be going for the same slot.
+ * The set does not grow: it has room for maxElts elements under MAX_LOAD. Walking the set, and
+ * getElements, are only safe while no thread is changing it. The caller owns the elements as before,
+ * and must not free a removed element while another thread might still be comparing against it.
+ */
+struct set
+{
+	int count;	/*number of elements*/
+	int length; /*length of array */
+	void **data; /*array of elements, NULL, or &deleted */
+	int (*compare)(); /* a compare function in the set */
+	unsigned (*hash)(); /* the hash function for the elements */
+	pthread_mutex_t locks[STRIPES]; /* the lock for each stripe of hashes */
+};
+typedef struct set SET;
+
+static char deleted;			// DELETED slots point here, which no element can
+
+/*
+ * Function: *createSet
+ * -------------------------------
+ * Summary: Allocates the set with every slot EMPTY and initializes the locks.
+ * Runtime: O(n)
+ */
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)()){
+	SET *sp;
+	int i;
+
+	sp=malloc(sizeof(SET));
+	assert(sp!=NULL);
+
+	sp->count = 0;
+	sp->length = maxElts*100/MAX_LOAD+1;
+	sp->data = calloc(sp->length, sizeof(void*));		// every slot starts out EMPTY
+	assert(sp->data!=NULL);
+	sp->compare = compare;
+	sp->hash = hash;
+	for (i = 0; i < STRIPES; i++) {
+		pthread_mutex_init(&sp->locks[i], NULL);
+	}
+	return sp;
+}
+
+/*
+ * Function: destroySet
+ * --------------------------------
+ * Summary: Destroys the locks and frees the array and then the set. No other thread may be using it.
+ * Runtime: O(1)
+ */
+void destroySet(SET *sp){
+	int i;
+
+	for (i = 0; i < STRIPES; i++) {
+		pthread_mutex_destroy(&sp->locks[i]);
+	}
+	free(sp->data);
+	free(sp);
+}
+
+/*
+ * Function: numElements
+ * ----------------------------------
+ * Summary: Returns the number of elements in the set, as of some moment during the call.
+ * Runtime: O(1)
+ */
+int numElements(SET *sp){
+	assert(sp!=NULL);
+	return __atomic_load_n(&sp->count, __ATOMIC_RELAXED);
+}
+
+/*
+ * Function: search
+ * ------------------------------------
+ * Summary: Walks the probe sequence of elt from its hash value. If elt is found, its index is returned and the element
+ * in the slot (as it was read, in case another thread changes the slot afterwards) is stored in *match. If not,
+ * the index of the first DELETED slot or the EMPTY slot that ended the walk is returned, so an add knows where to
+ * start looking for a slot to claim. Nothing is locked, so this is also the whole of a lookup.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static int search(SET *sp, void *elt, unsigned hash, void **match) {
+	int i, locn, freelocn = -1;
+	void *slot;
+
+	locn = hash%sp->length;
+	for (i = 0; i < sp->length; i++) {
+		slot = __atomic_load_n(&sp->data[locn], __ATOMIC_ACQUIRE);
+		if (slot == NULL) {
+			break;
+		}
+		if (slot == &deleted) {
+			if (freelocn == -1) {
+				freelocn = locn;
+			}
+		}
+		else if ((*sp->compare)(slot, elt) == 0) {
+			*match = slot;
+			return locn;
+		}
+		locn = (locn + 1)%sp->length;
+	}
+	*match = NULL;
+	return freelocn != -1 ? freelocn : i < sp->length ? locn : -1;
+}
+
+/*
+ * Function: claim
+ * -------------------------------------
+ * Summary: Puts elt, which the caller holds the stripe lock for and has just not found, in the first free slot from
+ * locn (where search stopped) with a compare-and-swap. If another thread adding a different element gets the slot
+ * first, we try the next free one.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void claim(SET *sp, int locn, void *elt){
+	int i;
+	void *slot;
+
+	assert(locn >= 0);									// the set is full
+	for (i = 0; i < sp->length; i++) {
+		slot = __atomic_load_n(&sp->data[locn], __ATOMIC_RELAXED);
+		if ((slot == NULL || slot == &deleted) &&
+				__atomic_compare_exchange_n(&sp->data[locn], &slot, elt, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+			break;
+		}
+		locn = (locn + 1)%sp->length;
+	}
+	assert(i < sp->length);
+	__atomic_fetch_add(&sp->count, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Function: addElement
+ * -------------------------------------
+ * Summary: If a lookup (without the lock) finds elt, there is nothing to do, which is the common case when adding
+ * the words of a text. Otherwise, under the stripe lock for elt, makes sure elt is still not in the set and then
+ * claims a slot for it.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void addElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	unsigned hash = (*sp->hash)(elt);
+	pthread_mutex_t *lock = &sp->locks[hash%STRIPES];
+	int locn;
+	void *match;
+
+	search(sp, elt, hash, &match);
+	if (match != NULL) {
+		return;
+	}
+	pthread_mutex_lock(lock);
+	locn = search(sp, elt, hash, &match);
+	if (match == NULL) {
+		claim(sp, locn, elt);
+	}
+	pthread_mutex_unlock(lock);
+}
+
+/*
+ * Function: removeElement
+ * ------------------------------------
+ * Summary: Under the stripe lock for elt, finds it and marks its slot DELETED. Only a thread holding that lock can
+ * change a slot holding elt, so a plain store is enough.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void removeElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	unsigned hash = (*sp->hash)(elt);
+	pthread_mutex_t *lock = &sp->locks[hash%STRIPES];
+	int locn;
+	void *match;
+
+	pthread_mutex_lock(lock);
+	locn = search(sp, elt, hash, &match);
+	if (match != NULL) {
+		__atomic_store_n(&sp->data[locn], (void *) &deleted, __ATOMIC_RELEASE);
+		__atomic_fetch_sub(&sp->count, 1, __ATOMIC_RELAXED);
+	}
+	pthread_mutex_unlock(lock);
+}
+
+/*
+ * Function: *toggleElement
+ * ------------------------------------
+ * Summary: Under the stripe lock for elt, removes the element if it is in the set and claims a slot for elt if not,
+ * with one search. Since the lock is held throughout, two threads toggling the same element take turns and each
+ * toggle counts. Returns the element that was removed, or NULL if elt was added.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void *toggleElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	unsigned hash = (*sp->hash)(elt);
+	pthread_mutex_t *lock = &sp->locks[hash%STRIPES];
+	int locn;
+	void *match;
+
+	pthread_mutex_lock(lock);
+	locn = search(sp, elt, hash, &match);
+	if (match != NULL) {
+		__atomic_store_n(&sp->data[locn], (void *) &deleted, __ATOMIC_RELEASE);
+		__atomic_fetch_sub(&sp->count, 1, __ATOMIC_RELAXED);
+	}
+	else {
+		claim(sp, locn, elt);
+	}
+	pthread_mutex_unlock(lock);
+	return match;
+}
+
+/*
+ * Function: *findElement
+ * -------------------------------------
+ * Summary: Returns the matching element, or NULL if there is none, without taking any lock.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void *findElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	void *match;
+
+	search(sp, elt, (*sp->hash)(elt), &match);
+	return match;
+}
+
+/*
+ * Function: **getElements
+ * ----------------------------------
+ * Summary: getElements returns a copy of the array for the user to play with
+ * Runtime: O(n)
+ */
+void *getElements(SET *sp){
+	assert(sp!=NULL);
+	void **arr, *elt;
+	int lastIndex = 0;
+	CURSOR cursor;
+
+	arr = malloc(sizeof(void*)*sp->count);
+	beginElements(sp, &cursor);
+	while ((elt = nextElement(&cursor)) != NULL){
+		arr[lastIndex++] = elt;
+	}
+	return arr;
+}
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor before the first element. No thread may change the set while it is being walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->index = 0;
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the element in the next slot that is neither EMPTY nor DELETED, or NULL when there are none left.
+ * Runtime: O(1) amortized
+ */
+void *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	SET *sp = cp->set;
+	void *slot;
+
+	while (cp->index < sp->length){
+		slot = sp->data[cp->index++];
+		if (slot != NULL && slot != &deleted){
+			return slot;
+		}
+	}
+	return NULL;
+}
@@ -13,16 +13,13 @@
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
-# include <assert.h>
-# include "set.h"
+# include "map.h"
+# include "words.h"
+# include "hash.h"
 
-struct entry {
-    char *word;
-    int count;
-};
 
-
-/* This is sufficient for the test cases in /scratch/coen12. */
+/* This is sufficient for the test cases in /scratch/coen12; the map grows
+   past it if need be. */
 
 # define MAX_SIZE 18000
 
@@ -35,37 +32,19 @@ struct entry {
 
 static unsigned strhash(char *s)
 {
-    unsigned hash = 0;
-
-
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
-
-    return hash;
+    return wyHash(s, strlen(s), 0);
 }
 
 
 /*
- * Function:	hashEntry
+ * Function:    copyWord
  *
- * Description:	Return a hash value for an entry based on its word.
+ * Description: Return a copy of a string S for the map to keep.
  */
 
-static unsigned hashEntry(struct entry *ep)
+static void *copyWord(char *s)
 {
-    return strhash(ep->word);
-}
-
-
-/*
- * Function:	compareEntries
- *
- * Description:	Compare two entries as in strcmp().
- */
-
-static int compareEntries(struct entry *ep1, struct entry *ep2)
-{
-    return strcmp(ep1->word, ep2->word);
+    return strdup(s);
 }
 
 
@@ -77,11 +56,11 @@ static int compareEntries(struct entry *ep1, struct entry *ep2)
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ];
-    struct entry e, *ep, **entries;
-    SET *counts;
-    int i;
+    WORDS *wp;
+    char buffer[BUFSIZ], *word;
+    MAPCURSOR cursor;
+    MAP *counts;
+    int *cp;
 
 
     /* Check usage and open the file. */
@@ -91,47 +70,32 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
 
 
-    /* Increment the count on each word read. */
-
-    counts = createSet(MAX_SIZE, compareEntries, hashEntry);
+    /* Increment the count on each word read.  The map keeps a copy of each
+       new word, and its count starts at zero. */
 
-    while (fscanf(fp, "%s", buffer) == 1) {
-	e.word = buffer;
-	ep = findElement(counts, &e);
+    counts = createMap(MAX_SIZE, sizeof(int), strcmp, strhash, copyWord);
 
-	if (ep == NULL) {
-	    ep = malloc(sizeof(struct entry));
-	    assert(ep != NULL);
+    while (readWord(wp, buffer, BUFSIZ) == 1)
+	(*(int *) findOrInsert(counts, buffer, NULL)) ++;
 
-	    ep->word = strdup(buffer);
-	    assert(ep->word != NULL);
-
-	    ep->count = 1;
-	    addElement(counts, ep);
-
-	} else
-	    ep->count ++;
-    }
+    closeWords(wp);
 
 
     /* Print out the counts for each word. */
 
-    entries = getElements(counts);
+    beginEntries(counts, &cursor);
 
-    for (i = 0; i < numElements(counts); i ++) {
-	printf("%s: %d\n", entries[i]->word, entries[i]->count);
-	free(entries[i]->word);
-	free(entries[i]);
+    while ((cp = nextEntry(&cursor, (void **) &word)) != NULL) {
+	printf("%s: %d\n", word, *cp);
+	free(word);
     }
 
-    free(entries);
-
-    destroySet(counts);
+    destroyMap(counts);
     exit(EXIT_SUCCESS);
 }
@@ -0,0 +1,340 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdbool.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "map.h"
+#define EMPTY 0
+#define DELETED 1
+#define FILLED 0x80
+#define GROUP 16
+#define MAX_LOAD 87
+#define MAX_ALIGN 16
+
+/*
+ * This file implements the map in map.h with the same table as table.c (details are commented above each
+ * function): a control byte per slot holding seven bits of the hash of its key, searched a GROUP at a time.
+ * Each slot holds the key pointer followed by the value itself, so a search that finds a key has the value on
+ * the same cache line, and adding an entry allocates nothing. The table is rebuilt, twice as long, once the
+ * FILLED and DELETED slots together pass MAX_LOAD percent of it, so the searches stay short.
+ */
+struct map
+{
+	int count;	/*number of entries*/
+	int used;	/*number of slots that are not EMPTY*/
+	int length; /*length of the arrays */
+	size_t stride; /*bytes in a slot */
+	size_t offset; /*where the value starts in a slot */
+	size_t valueSize; /*bytes in a value */
+	char *slots; /*array of keys and their values */
+	char *flags; /*array of flags (control bytes) */
+	int (*compare)(); /* the compare function for the keys */
+	unsigned (*hash)(); /* the hash function for the keys */
+	void *(*copy)(); /* copies a key being added, or NULL */
+};
+typedef struct map MAP;
+
+static int search(MAP *mp, void *key, unsigned hash, bool *found);		// prototyping the search function
+
+/*
+ * Function: keyAt
+ * -------------------------------
+ * Summary: Returns the address of the key in a slot, which the value follows.
+ * Runtime: O(1)
+ */
+static inline void **keyAt(MAP *mp, int locn) {
+	return (void **) (mp->slots + locn * mp->stride);
+}
+
+/*
+ * Function: tagOf
+ * -------------------------------
+ * Summary: Returns the flag for a FILLED slot holding a key with the given hash, as in table.c.
+ * Runtime: O(1)
+ */
+static inline char tagOf(unsigned hash) {
+	return FILLED | (hash * 0x9E3779B1u) >> 25;
+}
+
+/*
+ * Function: setFlag
+ * -------------------------------
+ * Summary: Sets the flag of a slot and of its copies past the end of the array.
+ * Runtime: O(1)
+ */
+static inline void setFlag(MAP *mp, int locn, char flag) {
+	int i;
+	mp->flags[locn] = flag;
+	for (i = locn + mp->length; i < mp->length + GROUP; i += mp->length) {
+		mp->flags[i] = flag;
+	}
+}
+
+/*
+ * Function: matchMask
+ * -------------------------------
+ * Summary: Returns a bit mask with bit i set if p[i] is equal to flag, for the GROUP flags at p.
+ * Runtime: O(1)
+ */
+static inline unsigned matchMask(char *p, char flag) {
+#ifdef __SSE2__
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) p), _mm_set1_epi8(flag)));
+#else
+	unsigned mask = 0;
+	int i;
+	for (i = 0; i < GROUP; i++) {
+		mask |= (unsigned) (p[i] == flag) << i;
+	}
+	return mask;
+#endif
+}
+
+/*
+ * Function: allocate
+ * -------------------------------
+ * Summary: Gives the map new, EMPTY arrays of the given length.
+ * Runtime: O(n)
+ */
+static void allocate(MAP *mp, int length) {
+	mp->length = length;
+	mp->used = 0;
+	mp->slots = malloc(mp->stride * length);					// malloc aligns for any value
+	mp->flags = calloc(length + GROUP, sizeof(char));			// every slot starts out EMPTY
+	assert(mp->slots != NULL && mp->flags != NULL);
+}
+
+/*
+ * Function: rehash
+ * -------------------------------
+ * Summary: Moves the entries into new arrays, twice as long if more than half of the allowed slots are FILLED
+ * and the same length otherwise, which just clears out the DELETED ones. No keys are compared, since they are
+ * all different: each goes in the first EMPTY slot from its hash.
+ * Runtime: O(n)
+ */
+static void rehash(MAP *mp) {
+	char *slots = mp->slots, *flags = mp->flags;
+	int i, locn, length = mp->length;
+	unsigned hash, empty;
+
+	allocate(mp, (long) mp->count * 200 > (long) length * MAX_LOAD ? length * 2 : length);
+	for (i = 0; i < length; i++) {
+		if (flags[i] & FILLED) {
+			hash = (*mp->hash)(*(void **) (slots + i * mp->stride));
+			locn = hash % mp->length;
+			while ((empty = matchMask(mp->flags + locn, EMPTY)) == 0) {
+				locn = (locn + GROUP) % mp->length;
+			}
+			locn = (locn + __builtin_ctz(empty)) % mp->length;
+			memcpy(keyAt(mp, locn), slots + i * mp->stride, mp->stride);
+			setFlag(mp, locn, tagOf(hash));
+			mp->used++;
+		}
+	}
+	free(slots);
+	free(flags);
+}
+
+/*
+ * Function: *createMap
+ * -------------------------------
+ * Summary: Allocates the map with room for maxElts entries before it has to grow. The value goes after the key
+ * pointer at the next multiple of its alignment, which we take to be the largest power of two (up to MAX_ALIGN)
+ * that divides its size, and slots are padded so that every one is aligned the same way.
+ * Runtime: O(n)
+ */
+MAP *createMap(int maxElts, size_t valueSize, int (*compare)(), unsigned (*hash)(), void *(*copy)()){
+	MAP *mp;
+	size_t align;
+
+	assert(maxElts >= 0 && compare != NULL && hash != NULL);
+	mp = malloc(sizeof(MAP));
+	assert(mp != NULL);
+
+	align = valueSize & -valueSize;								// the lowest bit set in the size
+	if (align == 0 || align > MAX_ALIGN) {
+		align = MAX_ALIGN;
+	}
+	if (align < sizeof(void *)) {
+		align = sizeof(void *);
+	}
+	mp->count = 0;
+	mp->valueSize = valueSize;
+	mp->offset = (sizeof(void *) + align - 1) / align * align;
+	mp->stride = (mp->offset + valueSize + align - 1) / align * align;
+	mp->compare = compare;
+	mp->hash = hash;
+	mp->copy = copy;
+	allocate(mp, (long) maxElts * 100 / MAX_LOAD + GROUP);
+	return mp;
+}
+
+/*
+ * Function: destroyMap
+ * --------------------------------
+ * Summary: Frees the arrays and then the map. The keys are the caller's to free, even copied ones.
+ * Runtime: O(1)
+ */
+void destroyMap(MAP *mp){
+	assert(mp != NULL);
+	free(mp->flags);
+	free(mp->slots);
+	free(mp);
+}
+
+/*
+ * Function: numEntries
+ * ----------------------------------
+ * Summary: Simply returns the number of entries in the map
+ * Runtime: O(1)
+ */
+int numEntries(MAP *mp){
+	assert(mp != NULL);
+	return mp->count;
+}
+
+/*
+ * Function: search
+ * ------------------------------------
+ * Summary: The search of table.c, on keys: returns the index of key with *found set if it is in the map, and
+ * otherwise the first DELETED slot before the first EMPTY one, or that EMPTY one if there was none.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static int search(MAP *mp, void *key, unsigned hash, bool *found) {
+	int locn = hash%mp->length;
+	char tag = tagOf(hash);
+	int i, j;
+	int deletedlocn=-1;
+	unsigned match, empty, deleted, before;
+
+	for (i = 0; i < mp->length; i += GROUP) {
+		empty = matchMask(mp->flags + locn, EMPTY);
+		before = empty != 0 ? (empty & -empty) - 1 : 0xFFFF;	// the slots before the first EMPTY one
+		match = matchMask(mp->flags + locn, tag) & before;
+		while (match != 0) {
+			j = (locn + __builtin_ctz(match))%mp->length;
+			if ((mp->compare)(*keyAt(mp, j),key)==0){
+				*found = true;
+				return j;
+			}
+			match &= match - 1;
+		}
+		if (deletedlocn == -1) {
+			deleted = matchMask(mp->flags + locn, DELETED) & before;
+			if (deleted != 0) {
+				deletedlocn = (locn + __builtin_ctz(deleted))%mp->length;
+			}
+		}
+		if (empty != 0) {
+			*found = false;
+			return deletedlocn != -1 ? deletedlocn : (locn + __builtin_ctz(empty))%mp->length;
+		}
+		locn = (locn + GROUP)%mp->length;
+	}
+	*found = false;
+	return deletedlocn;
+}
+
+/*
+ * Function: *findValue
+ * -------------------------------------
+ * Summary: Returns a pointer to the value for key, or NULL if key is not in the map.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void *findValue(MAP *mp, void *key){
+	assert(mp != NULL && key != NULL);
+	bool found;
+	int index = search(mp, key, (*mp->hash)(key), &found);
+	return found ? (char *) keyAt(mp, index) + mp->offset : NULL;
+}
+
+/*
+ * Function: *findOrInsert
+ * -------------------------------------
+ * Summary: Returns a pointer to the value for key, after adding key with a zeroed value if it was not in the map,
+ * which sets *inserted (if it is not NULL). The map is rebuilt first if it is as full as it may get, so the one
+ * search finds the slot to add to as well. That slot only counts as newly used if it was EMPTY, not DELETED.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void *findOrInsert(MAP *mp, void *key, bool *inserted){
+	assert(mp != NULL && key != NULL);
+	bool found;
+	unsigned hash = (*mp->hash)(key);
+	int index;
+	void **slot;
+
+	if ((long) mp->used * 100 >= (long) mp->length * MAX_LOAD) {
+		rehash(mp);
+	}
+	index = search(mp, key, hash, &found);
+	slot = keyAt(mp, index);
+	if (!found) {
+		if (mp->flags[index] == EMPTY) {
+			mp->used++;
+		}
+		*slot = mp->copy != NULL ? (*mp->copy)(key) : key;
+		assert(*slot != NULL);
+		memset((char *) slot + mp->offset, 0, mp->valueSize);
+		setFlag(mp, index, tagOf(hash));
+		mp->count++;
+	}
+	if (inserted != NULL) {
+		*inserted = !found;
+	}
+	return (char *) slot + mp->offset;
+}
+
+/*
+ * Function: *removeEntry
+ * ------------------------------------
+ * Summary: Removes the entry for key by marking its slot DELETED, and returns the key the map had for it (the
+ * copy, if keys are copied) so the caller can free it. Returns NULL if key is not in the map.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void *removeEntry(MAP *mp, void *key){
+	assert(mp != NULL && key != NULL);
+	bool found;
+	int index = search(mp, key, (*mp->hash)(key), &found);
+	if (!found) {
+		return NULL;
+	}
+	setFlag(mp, index, DELETED);
+	mp->count--;
+	return *keyAt(mp, index);
+}
+
+/*
+ * Function: beginEntries
+ * ----------------------------------
+ * Summary: Positions a cursor before the first entry, as beginElements does for a set. The map must not change
+ * while it is being walked.
+ * Runtime: O(1)
+ */
+void beginEntries(MAP *mp, MAPCURSOR *cp){
+	assert(mp != NULL && cp != NULL);
+	cp->map = mp;
+	cp->index = 0;
+}
+
+/*
+ * Function: *nextEntry
+ * ----------------------------------
+ * Summary: Moves the cursor to the next FILLED slot and returns a pointer to its value, storing its key in *key
+ * (if key is not NULL), or returns NULL when there are no entries left.
+ * Runtime: O(1) amortized
+ */
+void *nextEntry(MAPCURSOR *cp, void **key){
+	assert(cp != NULL);
+	MAP *mp = cp->map;
+
+	while (cp->index < mp->length){
+		if (mp->flags[cp->index++] & FILLED){
+			if (key != NULL) {
+				*key = *keyAt(mp, cp->index-1);
+			}
+			return (char *) keyAt(mp, cp->index-1) + mp->offset;
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,51 @@
+/*
+ * File:        map.h
+ *
+ * Description: This file contains the public function and type
+ *              declarations for a map abstract data type from generic
+ *              pointer keys to values of a fixed size.  A map is an
+ *              unordered collection of entries with distinct keys.
+ *
+ *              The values are stored in the map itself, next to their
+ *              keys, and the functions that find an entry return a
+ *              pointer to its value, so it can be read or updated in
+ *              place.  Such a pointer stays valid until the next entry is
+ *              added or removed.  findOrInsert adds an entry with a value
+ *              of all zero bytes if the key is not in the map, so looking
+ *              up and adding take a single search.  If the map is created
+ *              with a copy function, it is called on a key when its entry
+ *              is added, and the map keeps the copy; the caller still
+ *              frees the keys.  The map grows as needed.
+ */
+
+# ifndef MAP_H
+# define MAP_H
+
+# include <stddef.h>
+# include <stdbool.h>
+
+typedef struct map MAP;
+
+typedef struct mapcursor {
+    MAP *map;
+    int index;
+} MAPCURSOR;
+
+MAP *createMap(int maxElts, size_t valueSize, int (*compare)(),
+    unsigned (*hash)(), void *(*copy)());
+
+void destroyMap(MAP *mp);
+
+int numEntries(MAP *mp);
+
+void *findValue(MAP *mp, void *key);
+
+void *findOrInsert(MAP *mp, void *key, bool *inserted);
+
+void *removeEntry(MAP *mp, void *key);
+
+void beginEntries(MAP *mp, MAPCURSOR *cp);
+
+void *nextEntry(MAPCURSOR *cp, void **key);
+
+# endif /* MAP_H */
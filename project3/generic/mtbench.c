@@ -0,0 +1,261 @@
+/*
+ * File:        mtbench.c
+ *
+ * Description: This file contains a benchmark for the concurrent set in
+ *              concurrent.c.
+ *
+ *              The program reads the words of the files given as command
+ *              line arguments into memory.  Then, for 1, 2, 4, ... threads
+ *              up to the limit given with -t, it splits the words evenly
+ *              among the threads and has them all work on one shared set:
+ *              first adding every word (as unique does), and then counting
+ *              every word (as counts does).  The time taken and the speedup
+ *              over one thread are printed for each.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <assert.h>
+# include <unistd.h>
+# include <pthread.h>
+# include <time.h>
+# include "set.h"
+# include "words.h"
+# include "hash.h"
+
+# define MAX_THREADS 32
+
+struct entry {
+    char *word;
+    int count;
+};
+
+struct job {
+    SET *set;
+    char **words;
+    int start, end;
+};
+
+
+/*
+ * Function:    strhash
+ *
+ * Description: Return a hash value for a string S.
+ */
+
+static unsigned strhash(char *s)
+{
+    return wyHash(s, strlen(s), 0);
+}
+
+
+/*
+ * Function:	hashEntry
+ *
+ * Description:	Return a hash value for an entry based on its word.
+ */
+
+static unsigned hashEntry(struct entry *ep)
+{
+    return strhash(ep->word);
+}
+
+
+/*
+ * Function:	compareEntries
+ *
+ * Description:	Compare two entries as in strcmp().
+ */
+
+static int compareEntries(struct entry *ep1, struct entry *ep2)
+{
+    return strcmp(ep1->word, ep2->word);
+}
+
+
+/*
+ * Function:    addWords
+ *
+ * Description: Add the words of a job to its set.
+ */
+
+static void *addWords(void *arg)
+{
+    struct job *jp = arg;
+    int i;
+
+
+    for (i = jp->start; i < jp->end; i ++)
+	addElement(jp->set, jp->words[i]);
+
+    return NULL;
+}
+
+
+/*
+ * Function:    countEntries
+ *
+ * Description: Count the words of a job in its set of entries.  Two
+ *		threads can both miss a new word and both add an entry for
+ *		it, so after adding we look the word up again and use
+ *		whichever entry the set kept.
+ */
+
+static void *countEntries(void *arg)
+{
+    struct job *jp = arg;
+    struct entry e, *ep, *np;
+    int i;
+
+
+    for (i = jp->start; i < jp->end; i ++) {
+	e.word = jp->words[i];
+	ep = findElement(jp->set, &e);
+
+	if (ep == NULL) {
+	    np = malloc(sizeof(struct entry));
+	    assert(np != NULL);
+
+	    np->word = jp->words[i];
+	    np->count = 0;
+	    addElement(jp->set, np);
+
+	    ep = findElement(jp->set, &e);
+
+	    if (ep != np)
+		free(np);
+	}
+
+	__atomic_fetch_add(&ep->count, 1, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    run
+ *
+ * Description: Split N words among THREADS threads running WORKER on SP
+ *		and return the number of seconds they took.
+ */
+
+static double run(SET *sp, char **words, int n, int threads,
+    void *(*worker)(void *))
+{
+    pthread_t tids[MAX_THREADS];
+    struct job jobs[MAX_THREADS];
+    struct timespec start, end;
+    int i;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < threads; i ++) {
+	jobs[i].set = sp;
+	jobs[i].words = words;
+	jobs[i].start = (long) n * i / threads;
+	jobs[i].end = (long) n * (i + 1) / threads;
+	pthread_create(&tids[i], NULL, worker, &jobs[i]);
+    }
+
+    for (i = 0; i < threads; i ++)
+	pthread_join(tids[i], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    int i, c, n, size, threads, maxThreads;
+    double secs, base[2];
+    char buffer[BUFSIZ], **words;
+    struct entry *ep;
+    CURSOR cursor;
+    long total;
+    WORDS *wp;
+    SET *sp;
+
+
+    /* Check usage and read in the words. */
+
+    maxThreads = MAX_THREADS;
+
+    while ((c = getopt(argc, argv, "t:")) != -1)
+	if (c == 't')
+	    maxThreads = atoi(optarg);
+	else
+	    optind = argc + 1;
+
+    if (optind >= argc || maxThreads < 1 || maxThreads > MAX_THREADS) {
+	fprintf(stderr, "usage: %s [-t threads] file ...\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    n = 0;
+    size = 1024;
+    words = malloc(sizeof(char *) * size);
+
+    for (i = optind; i < argc; i ++) {
+	if ((wp = openWords(argv[i])) == NULL) {
+	    fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[i]);
+	    exit(EXIT_FAILURE);
+	}
+
+	while (readWord(wp, buffer, BUFSIZ) == 1) {
+	    if (n == size)
+		words = realloc(words, sizeof(char *) * (size *= 2));
+
+	    words[n ++] = strdup(buffer);
+	}
+
+	closeWords(wp);
+    }
+
+
+    /* Run both workloads on a fresh set with more and more threads. */
+
+    printf("%d words\n", n);
+    printf("%7s %10s %8s %8s %10s %8s\n", "threads", "unique", "speedup",
+	"distinct", "counts", "speedup");
+
+    for (threads = 1; threads <= maxThreads; threads *= 2) {
+	sp = createSet(n, strcmp, strhash);
+	secs = run(sp, words, n, threads, addWords);
+	base[0] = threads == 1 ? secs : base[0];
+	printf("%7d %9.3fs %7.2fx %8d", threads, secs, base[0] / secs,
+	    numElements(sp));
+	destroySet(sp);
+
+	sp = createSet(n, compareEntries, hashEntry);
+	secs = run(sp, words, n, threads, countEntries);
+	base[1] = threads == 1 ? secs : base[1];
+	printf(" %9.3fs %7.2fx\n", secs, base[1] / secs);
+
+	total = 0;
+	beginElements(sp, &cursor);
+
+	while ((ep = nextElement(&cursor)) != NULL) {
+	    total += ep->count;
+	    free(ep);
+	}
+
+	assert(total == n);
+	destroySet(sp);
+    }
+
+    for (i = 0; i < n; i ++)
+	free(words[i]);
+
+    free(words);
+    exit(EXIT_SUCCESS);
+}
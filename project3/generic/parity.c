@@ -16,6 +16,8 @@
 # include <stdlib.h>
 # include <string.h>
 # include "set.h"
+# include "words.h"
+# include "hash.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -31,13 +33,7 @@
 
 static unsigned strhash(char *s)
 {
-    unsigned hash = 0;
-
-
-    while (*s != '\0')
-        hash = 31 * hash + *s ++;
-
-    return hash;
+    return wyHash(s, strlen(s), 0);
 }
 
 
@@ -49,8 +45,8 @@ static unsigned strhash(char *s)
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ], *word;
+    WORDS *wp;
+    char buffer[BUFSIZ], *word, *match;
     SET *odd;
     int words;
 
@@ -62,30 +58,31 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
 
 
-    /* Insert or delete words to compute their parity. */
+    /* Insert or delete words to compute their parity, with one search
+       for each.  The set keeps the copy of a word it adds. */
 
     words = 0;
     odd = createSet(MAX_SIZE, strcmp, strhash);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
+    while (readWord(wp, buffer, BUFSIZ) == 1) {
         words ++;
+        word = strdup(buffer);
 
-        if ((word = findElement(odd, buffer)) != NULL) {
-            removeElement(odd, buffer);
+        if ((match = toggleElement(odd, word)) != NULL) {
+	    free(match);
 	    free(word);
-	} else
-            addElement(odd, strdup(buffer));
+	}
     }
 
     printf("%d total words\n", words);
     printf("%d words occur an odd number of times\n", numElements(odd));
-    fclose(fp);
+    closeWords(wp);
 
     destroySet(odd);
     exit(EXIT_SUCCESS);
@@ -0,0 +1,396 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "robin.h"
+#define EMPTY 0
+#define FILLED 1
+#define MAX_LOAD 80
+#define MIN_LOAD 20
+#define MIN_LENGTH 16
+
+/*
+ * This file implements the same set as table.c with Robin Hood hashing instead of plain linear
+ * probing. An element being inserted takes the slot of any element that is closer to its home slot
+ * than the new one is to its own, so every element ends up about as far from home as every other,
+ * and a search can stop as soon as it meets an element closer to home than it has come. Removing an
+ * element shifts the ones after it back a slot instead of leaving a DELETED flag, so there are no
+ * tombstones and the probe sequences stay short however many removes there are. The short probes
+ * let the table fill up to MAX_LOAD percent before it doubles (details are commented above each
+ * function).
+ */
+struct set
+{
+	int count;	/*number of elements*/
+	int length; /*length of array */
+	void **data; /*array of elements */
+	unsigned *hashes; /*hash of each element, so we can find its home slot again */
+	char *flags; /*array of flags */
+	int (*compare)(); /* a compare function in the set */
+	unsigned (*hash)(); /* the hash function for the elements */
+};
+typedef struct set SET;
+
+/*
+ * Function: distance
+ * -------------------------------
+ * Summary: Returns how far the element in slot locn is from its home slot.
+ * Runtime: O(1)
+ */
+static inline int distance(SET *sp, int locn) {
+	int head = sp->hashes[locn]%sp->length;
+	return locn >= head ? locn - head : locn + sp->length - head;
+}
+
+/*
+ * Function: allocate
+ * -------------------------------
+ * Summary: Gives the set empty arrays of the given length.
+ * Runtime: O(n)
+ */
+static void allocate(SET *sp, int length) {
+	sp->length = length;
+	sp->data = malloc(sizeof(void*)*length);
+	sp->hashes = malloc(sizeof(unsigned)*length);
+	sp->flags = calloc(length, sizeof(char));		// every flag starts out EMPTY
+	assert(sp->data!=NULL && sp->hashes!=NULL && sp->flags!=NULL);
+}
+
+/*
+ * Function: *createSet
+ * -------------------------------
+ * Summary: Allocates the set with room for maxElts elements under MAX_LOAD. maxElts is only a hint:
+ * unlike table.c, the table grows when it needs to.
+ * Runtime: O(n)
+ */
+SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)()){
+	SET *sp;
+
+	sp=malloc(sizeof(SET));
+	assert(sp!=NULL);
+
+	sp->count = 0;
+	sp->compare = compare;
+	sp->hash = hash;
+	allocate(sp, maxElts*100/MAX_LOAD+1 < MIN_LENGTH ? MIN_LENGTH : maxElts*100/MAX_LOAD+1);
+	return sp;
+}
+
+/*
+ * Function: destroySet
+ * --------------------------------
+ * Summary: Frees the arrays and then the set. The elements belong to the caller.
+ * Runtime: O(1)
+ */
+void destroySet(SET *sp){
+	free(sp->flags);
+	free(sp->hashes);
+	free(sp->data);
+	free(sp);
+}
+
+/*
+ * Function: numElements
+ * ----------------------------------
+ * Summary: Simply returns the number of elements in the set
+ * Runtime: O(1)
+ */
+int numElements(SET *sp){
+	assert(sp!=NULL);
+	return sp->count;
+}
+
+/*
+ * Function: search
+ * ------------------------------------
+ * Summary: Walks forward from the home slot of elt. Because of the way elements are placed, once we
+ * reach an EMPTY slot or an element that is closer to its home than we are to ours, elt cannot be
+ * further on. The stored hashes are compared first so the compare function is only called on a likely match.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static int search(SET *sp, void *elt, unsigned hash, bool *found) {
+	int locn = hash%sp->length;
+	int dist;
+
+	for (dist = 0; sp->flags[locn] == FILLED && distance(sp, locn) >= dist; dist++) {
+		if (sp->hashes[locn] == hash && (*sp->compare)(sp->data[locn], elt) == 0) {
+			*found = true;
+			return locn;
+		}
+		locn = (locn + 1)%sp->length;
+	}
+	*found = false;
+	return locn;
+}
+
+/*
+ * Function: displace
+ * ------------------------------------
+ * Summary: Puts an element that is not in the set into it, starting at locn, which is dist slots past
+ * its home. Whenever we pass an element that is closer to its home than the one we are carrying, we
+ * swap them and carry on with the one we displaced, until we reach an EMPTY slot.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void displace(SET *sp, int locn, int dist, void *elt, unsigned hash) {
+	int other;
+	void *tmp;
+	unsigned tmphash;
+
+	while (sp->flags[locn] == FILLED) {
+		other = distance(sp, locn);
+		if (other < dist) {							// the resident is better off than us, so it moves on instead
+			tmp = sp->data[locn];
+			tmphash = sp->hashes[locn];
+			sp->data[locn] = elt;
+			sp->hashes[locn] = hash;
+			elt = tmp;
+			hash = tmphash;
+			dist = other;
+		}
+		locn = (locn + 1)%sp->length;
+		dist++;
+	}
+	sp->data[locn] = elt;
+	sp->hashes[locn] = hash;
+	sp->flags[locn] = FILLED;
+}
+
+/*
+ * Function: place
+ * ------------------------------------
+ * Summary: Puts an element that is not in the set into it, starting at its home slot.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void place(SET *sp, void *elt, unsigned hash) {
+	displace(sp, hash%sp->length, 0, elt, hash);
+}
+
+/*
+ * Function: rehash
+ * ------------------------------------
+ * Summary: Moves every element into new arrays of the given length. The hashes are kept so the
+ * hash function is not called again.
+ * Runtime: O(n)
+ */
+static void rehash(SET *sp, int length) {
+	void **data = sp->data;
+	char *flags = sp->flags;
+	unsigned *hashes = sp->hashes;
+	int i, oldlength = sp->length;
+
+	allocate(sp, length);
+	for (i = 0; i < oldlength; i++) {
+		if (flags[i] == FILLED) {
+			place(sp, data[i], hashes[i]);
+		}
+	}
+	free(data);
+	free(hashes);
+	free(flags);
+}
+
+/*
+ * Function: insert
+ * -------------------------------------
+ * Summary: Puts elt, which a search for it stopped at locn without finding, into the set. Every slot the search
+ * passed holds an element at least as far from home as elt would be, so placing can carry on from where the
+ * search stopped. If the set would go over MAX_LOAD it is doubled first, and elt is placed from its home in the
+ * new table instead.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void insert(SET *sp, int locn, void *elt, unsigned hash){
+	if ((long) (sp->count+1)*100 > (long) sp->length*MAX_LOAD) {
+		rehash(sp, sp->length*2);
+		place(sp, elt, hash);
+	}
+	else {
+		displace(sp, locn, (locn + sp->length - hash%sp->length)%sp->length, elt, hash);
+	}
+	sp->count++;
+}
+
+/*
+ * Function: removeAt
+ * ------------------------------------
+ * Summary: Shifts the elements after locn back one slot until we reach an EMPTY slot or an element already in its
+ * home slot. That leaves the table exactly as if the element at locn had never been added, with no DELETED flag.
+ * If the set falls under MIN_LOAD it is halved.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void removeAt(SET *sp, int locn){
+	int next;
+
+	next = (locn + 1)%sp->length;
+	while (sp->flags[next] == FILLED && distance(sp, next) > 0) {
+		sp->data[locn] = sp->data[next];
+		sp->hashes[locn] = sp->hashes[next];
+		locn = next;
+		next = (next + 1)%sp->length;
+	}
+	sp->flags[locn] = EMPTY;
+	sp->count--;
+	if ((long) sp->count*100 < (long) sp->length*MIN_LOAD && sp->length/2 >= MIN_LENGTH) {
+		rehash(sp, sp->length/2);
+	}
+}
+
+/*
+ * Function: addElement
+ * -------------------------------------
+ * Summary: If elt is not in the set, it is inserted from where the search for it stopped.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void addElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool found;
+	unsigned hash = (*sp->hash)(elt);
+	int locn = search(sp, elt, hash, &found);
+
+	if (!found) {
+		insert(sp, locn, elt, hash);
+	}
+}
+
+/*
+ * Function: removeElement
+ * ------------------------------------
+ * Summary: If elt is found, it is removed with removeAt.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void removeElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool found;
+	int locn = search(sp, elt, (*sp->hash)(elt), &found);
+
+	if (found) {
+		removeAt(sp, locn);
+	}
+}
+
+/*
+ * Function: *toggleElement
+ * ------------------------------------
+ * Summary: Removes the element if it is in the set and inserts elt if not, both from where the one search for it
+ * stopped. Returns the element that was removed, for the caller to free, or NULL if elt was added.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void *toggleElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool found;
+	unsigned hash = (*sp->hash)(elt);
+	int locn = search(sp, elt, hash, &found);
+	void *match;
+
+	if (found) {
+		match = sp->data[locn];
+		removeAt(sp, locn);
+		return match;
+	}
+	insert(sp, locn, elt, hash);
+	return NULL;
+}
+
+/*
+ * Function: *findElement
+ * -------------------------------------
+ * Summary: Returns the matching element, or NULL if there is none.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void *findElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool found;
+	int locn = search(sp, elt, (*sp->hash)(elt), &found);
+	return found ? sp->data[locn] : NULL;
+}
+
+/*
+ * Function: **getElements
+ * ----------------------------------
+ * Summary: getElements returns a copy of the array for the user to play with
+ * Runtime: O(n)
+ */
+void *getElements(SET *sp){
+	assert(sp!=NULL);
+	void **arr;
+	int i, lastIndex = 0;
+
+	arr = malloc(sizeof(void*)*sp->count);
+	for (i = 0; i < sp->length; i++){
+		if (sp->flags[i] == FILLED){
+			arr[lastIndex++] = sp->data[i];
+		}
+	}
+	return arr;
+}
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor before the first element. The set must not change while it is being
+ * walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->index = 0;
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the element in the next FILLED slot, or NULL when there are none left.
+ * Runtime: O(1) amortized
+ */
+void *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	SET *sp = cp->set;
+
+	while (cp->index < sp->length){
+		if (sp->flags[cp->index++] == FILLED){
+			return sp->data[cp->index-1];
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Function: averageProbe
+ * ----------------------------------
+ * Summary: Returns the average number of slots a successful search looks at, which is one more than
+ * the average distance of the elements from their home slots.
+ * Runtime: O(n)
+ */
+double averageProbe(SET *sp){
+	assert(sp!=NULL);
+	long total = 0;
+	int i;
+
+	if (sp->count == 0)
+		return 0;
+	for (i = 0; i < sp->length; i++){
+		if (sp->flags[i] == FILLED){
+			total += distance(sp, i) + 1;
+		}
+	}
+	return (double) total / sp->count;
+}
+
+/*
+ * Function: maxProbe
+ * ----------------------------------
+ * Summary: Returns the most slots any successful search looks at, the longest distance from home
+ * plus one.
+ * Runtime: O(n)
+ */
+int maxProbe(SET *sp){
+	assert(sp!=NULL);
+	int i, max = 0;
+
+	for (i = 0; i < sp->length; i++){
+		if (sp->flags[i] == FILLED && distance(sp, i) + 1 > max){
+			max = distance(sp, i) + 1;
+		}
+	}
+	return max;
+}
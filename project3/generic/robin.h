@@ -0,0 +1,20 @@
+/*
+ * File:        robin.h
+ *
+ * Description: This file contains the declarations for the functions
+ *              that only the Robin Hood set has, on top of those in set.h.
+ *              They report how far the elements are from their home slots,
+ *              which is how many slots a search has to look at; churn.c
+ *              prints them while half of a set is removed and added back.
+ */
+
+# ifndef ROBIN_H
+# define ROBIN_H
+
+# include "set.h"
+
+double averageProbe(SET *sp);
+
+int maxProbe(SET *sp);
+
+# endif /* ROBIN_H */
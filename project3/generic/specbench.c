@@ -0,0 +1,336 @@
+/*
+ * File:        specbench.c
+ *
+ * Description: This file contains a benchmark comparing the set in set.h,
+ *              which calls its hash and compare functions through
+ *              pointers, with sets generated for one element type by
+ *              template.h, on the work that counts does.
+ *
+ *              The program reads the words of the files given as command
+ *              line arguments into memory and counts how often each occurs
+ *              four ways: with the set in set.h holding pointers to
+ *              entries as counts.c used to, with a template set holding
+ *              the same pointers, with a template set holding the entries
+ *              themselves, and with the map in map.h as counts.c uses it
+ *              now.  The sets are made big enough to be filled to the
+ *              given load (50% unless -l is given), and the map is given
+ *              room for as many entries as the sets have slots and sizes
+ *              its table itself.  The counting is repeated until at least
+ *              a few million words have been counted.  The time per word
+ *              for each is printed.  Build it with optimization for the
+ *              numbers to mean anything, as in
+ *              make CFLAGS="-O2 -I../../common" specbench.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <assert.h>
+# include <unistd.h>
+# include <time.h>
+# include "set.h"
+# include "words.h"
+# include "hash.h"
+# include "template.h"
+# include "map.h"
+
+# define LOAD 50
+# define MIN_WORDS (4 << 20)
+
+struct entry {
+    char *word;
+    int count;
+};
+
+
+/*
+ * Function:    hashWord
+ *
+ * Description: Return a hash value for a word.
+ */
+
+static unsigned hashWord(char *s)
+{
+    return wyHash(s, strlen(s), 0);
+}
+
+
+/*
+ * Function:	hashEntry
+ *
+ * Description:	Return a hash value for an entry based on its word.
+ */
+
+static unsigned hashEntry(struct entry *ep)
+{
+    return hashWord(ep->word);
+}
+
+
+/*
+ * Function:	compareEntries
+ *
+ * Description:	Compare two entries as in strcmp().
+ */
+
+static int compareEntries(struct entry *ep1, struct entry *ep2)
+{
+    return strcmp(ep1->word, ep2->word);
+}
+
+
+/* The template sets: one of pointers to entries and one of entries. */
+
+# define HASH_POINTER(ep) wyHash((ep)->word, strlen((ep)->word), 0)
+# define EQUAL_POINTERS(ep1, ep2) (strcmp((ep1)->word, (ep2)->word) == 0)
+# define HASH_ENTRY(e) wyHash((e).word, strlen((e).word), 0)
+# define EQUAL_ENTRIES(e1, e2) (strcmp((e1).word, (e2).word) == 0)
+
+DEFINE_SET(pointer, struct entry *, HASH_POINTER, EQUAL_POINTERS)
+
+DEFINE_SET(entry, struct entry, HASH_ENTRY, EQUAL_ENTRIES)
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the time in seconds.
+ */
+
+static double now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/*
+ * Function:    countGeneric
+ *
+ * Description: Count the N words in WORDS with the set in set.h of SIZE
+ *		slots, as counts does, and return the number of entries.
+ */
+
+static int countGeneric(char **words, int n, int size)
+{
+    struct entry e, *ep;
+    CURSOR cursor;
+    SET *sp;
+    int i;
+
+
+    sp = createSet(size, compareEntries, hashEntry);
+
+    for (i = 0; i < n; i ++) {
+	e.word = words[i];
+	ep = findElement(sp, &e);
+
+	if (ep == NULL) {
+	    ep = malloc(sizeof(struct entry));
+	    assert(ep != NULL);
+	    ep->word = words[i];
+	    ep->count = 1;
+	    addElement(sp, ep);
+	} else
+	    ep->count ++;
+    }
+
+    n = numElements(sp);
+    beginElements(sp, &cursor);
+
+    while ((ep = nextElement(&cursor)) != NULL)
+	free(ep);
+
+    destroySet(sp);
+    return n;
+}
+
+
+/*
+ * Function:    countPointers
+ *
+ * Description: Count the words as countGeneric does, with a template set
+ *		of pointers to entries.
+ */
+
+static int countPointers(char **words, int n, int size)
+{
+    struct entry e, *ep, **epp;
+    pointerCursor cursor;
+    pointerSet *sp;
+    int i;
+
+
+    sp = pointerCreateSet(size);
+
+    for (i = 0; i < n; i ++) {
+	e.word = words[i];
+	epp = pointerFindElement(sp, &e);
+
+	if (epp == NULL) {
+	    ep = malloc(sizeof(struct entry));
+	    assert(ep != NULL);
+	    ep->word = words[i];
+	    ep->count = 1;
+	    pointerAddElement(sp, ep);
+	} else
+	    (*epp)->count ++;
+    }
+
+    n = pointerNumElements(sp);
+    pointerBeginElements(sp, &cursor);
+
+    while ((epp = pointerNextElement(&cursor)) != NULL)
+	free(*epp);
+
+    pointerDestroySet(sp);
+    return n;
+}
+
+
+/*
+ * Function:    countEntries
+ *
+ * Description: Count the words as countGeneric does, with a template set
+ *		that holds the entries themselves and is updated in place.
+ */
+
+static int countEntries(char **words, int n, int size)
+{
+    struct entry e, *ep;
+    entrySet *sp;
+    int i;
+
+
+    sp = entryCreateSet(size);
+
+    for (i = 0; i < n; i ++) {
+	e.word = words[i];
+	e.count = 1;
+
+	if ((ep = entryFindElement(sp, e)) == NULL)
+	    entryAddElement(sp, e);
+	else
+	    ep->count ++;
+    }
+
+    n = entryNumElements(sp);
+    entryDestroySet(sp);
+    return n;
+}
+
+
+/*
+ * Function:    countMap
+ *
+ * Description: Count the words as countGeneric does, with the map in map.h
+ *		holding the counts and one search per word.
+ */
+
+static int countMap(char **words, int n, int size)
+{
+    MAP *mp;
+    int i;
+
+
+    mp = createMap(size, sizeof(int), strcmp, hashWord, NULL);
+
+    for (i = 0; i < n; i ++)
+	(*(int *) findOrInsert(mp, words[i], NULL)) ++;
+
+    n = numEntries(mp);
+    destroyMap(mp);
+    return n;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    static char *names[] = {"set.h", "template, pointers", "template, entries",
+	"map.h"};
+    static int (*counters[])(char **, int, int) =
+	{countGeneric, countPointers, countEntries, countMap};
+    int i, c, n, size, load, distinct, rounds, round;
+    char buffer[BUFSIZ], **words;
+    double start, secs;
+    WORDS *wp;
+
+
+    /* Check usage and read in the words. */
+
+    load = LOAD;
+
+    while ((c = getopt(argc, argv, "l:")) != -1)
+	if (c == 'l')
+	    load = atoi(optarg);
+	else
+	    optind = argc + 1;
+
+    if (optind >= argc || load < 1 || load > 100) {
+	fprintf(stderr, "usage: %s [-l load] file ...\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+    n = 0;
+    size = 1024;
+    words = malloc(sizeof(char *) * size);
+
+    for (i = optind; i < argc; i ++) {
+	if ((wp = openWords(argv[i])) == NULL) {
+	    fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[i]);
+	    exit(EXIT_FAILURE);
+	}
+
+	while (readWord(wp, buffer, BUFSIZ) == 1) {
+	    if (n == size)
+		words = realloc(words, sizeof(char *) * (size *= 2));
+
+	    words[n ++] = strdup(buffer);
+	}
+
+	closeWords(wp);
+    }
+
+    if (n == 0) {
+	fprintf(stderr, "%s: no words\n", argv[0]);
+	exit(EXIT_FAILURE);
+    }
+
+
+    /* Count them every way, checking that the ways agree. */
+
+    distinct = countEntries(words, n, n);
+    size = (long) distinct * 100 / load + 1;
+    rounds = n < MIN_WORDS ? (MIN_WORDS + n - 1) / n : 1;
+
+    printf("%d words, %d distinct, %d slots, %d rounds\n", n, distinct, size,
+	rounds);
+
+    for (c = 0; c < sizeof(names) / sizeof(names[0]); c ++) {
+	start = now();
+
+	for (round = 0; round < rounds; round ++)
+	    if ((*counters[c])(words, n, size) != distinct) {
+		fprintf(stderr, "%s: %s disagrees\n", argv[0], names[c]);
+		exit(EXIT_FAILURE);
+	    }
+
+	secs = now() - start;
+	printf("%-20s %7.1f ns/word\n", names[c], secs * 1e9 / n / rounds);
+    }
+
+    for (i = 0; i < n; i ++)
+	free(words[i]);
+
+    free(words);
+    exit(EXIT_SUCCESS);
+}
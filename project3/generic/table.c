@@ -2,14 +2,24 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdbool.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "set.h"
 #define EMPTY 0
-#define FILLED 1
-#define DELETED 2
+#define DELETED 1
+#define FILLED 0x80
+#define GROUP 16
 
 /*
  * This file defines the struct called set and implements its 
  * different functions including creating and destroying the set, adding and removing elements, 
  * and searching (details are commented above each function).
+ * Each flag is a control byte: a FILLED slot keeps seven bits of its element's hash under the FILLED
+ * bit, so a search can check a whole GROUP of flags against the hash at once (with SSE2 where it is
+ * available) and only calls the compare function on the slots whose bits match. The flags array has
+ * GROUP extra bytes at the end that copy the first ones, so a group starting near the end can be
+ * read in one go.
  * @author: Jonathan Trinh
  * @version: 5042017
  */
@@ -18,13 +28,57 @@ struct set
 	int count;	/*number of elements*/
 	int length; /*length of array */
 	void **data; /*array of strings */
-	char* flags; /*array of flags */
+	char* flags; /*array of flags (control bytes) */
 	int (*compare)(); /* a compare function in the set */
 	unsigned(*hash)(); /* equivalent of strhash stored in the set */
 };
 typedef struct set SET;
 
-static int search(SET *sp, void *elt, bool *found);		// prototyping the search function
+static int search(SET *sp, void *elt, unsigned hash, bool *found);		// prototyping the search function
+
+/*
+ * Function: tagOf
+ * -------------------------------
+ * Summary: Returns the flag for a FILLED slot holding an element with the given hash: the FILLED bit
+ * and seven bits of the hash. The hash is multiplied first so that the top bits depend on all of it.
+ * Runtime: O(1)
+ */
+static inline char tagOf(unsigned hash) {
+	return FILLED | (hash * 0x9E3779B1u) >> 25;
+}
+
+/*
+ * Function: setFlag
+ * -------------------------------
+ * Summary: Sets the flag of a slot and of its copies past the end of the array.
+ * Runtime: O(1)
+ */
+static inline void setFlag(SET *sp, int locn, char flag) {
+	int i;
+	sp->flags[locn] = flag;
+	for (i = locn + sp->length; i < sp->length + GROUP; i += sp->length) {
+		sp->flags[i] = flag;
+	}
+}
+
+/*
+ * Function: matchMask
+ * -------------------------------
+ * Summary: Returns a bit mask with bit i set if p[i] is equal to flag, for the GROUP flags at p.
+ * Runtime: O(1)
+ */
+static inline unsigned matchMask(char *p, char flag) {
+#ifdef __SSE2__
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) p), _mm_set1_epi8(flag)));
+#else
+	unsigned mask = 0;
+	int i;
+	for (i = 0; i < GROUP; i++) {
+		mask |= (unsigned) (p[i] == flag) << i;
+	}
+	return mask;
+#endif
+}
 
 /*
  * Function: *createSet
@@ -44,11 +98,11 @@ SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)() ){
 	sp->count = 0;								// this count element keeps track of the number of elements currently in the set
 	sp->length=maxElts;							// this is the length of the array
 	sp->data = malloc(sizeof(void*)*maxElts);	// this is an character array where the actual data is stored
-	sp->flags = malloc(sizeof(char*)*maxElts);
+	sp->flags = malloc(sizeof(char)*(maxElts+GROUP));	// with room for the copies at the end
 	sp->compare = compare;
 	sp->hash = hash;
 	int i;
-	for (i = 0; i < maxElts; i++) {
+	for (i = 0; i < maxElts+GROUP; i++) {
 		sp->flags[i] = EMPTY;
 	}
 	assert(sp->data!=NULL);
@@ -82,39 +136,46 @@ int numElements(SET *sp){
 /*
  * Function: search
  * ------------------------------------
- * Summary: This search function performs a search using linear probing. It starts by assigning a starting hash value and keeps
- * track of a deleted location. We then loop through the array checking to see if the locations are FILLED, DELETED, or EMPTY.
- * If FILLED, then we have found the element and simply return its index. If DELETED, then we remember the first deleted location.
- * Otherwise, if it is not the above options,it must be EMPTY, and we have not found the element. If we have not seen a deleted location
- * previously, we return the empty index all the way at the end. Otherwise, we return the first deleted location/index.
+ * Summary: This search function performs a search using linear probing, a GROUP of slots at a time. Starting at the hash
+ * value, we get masks of the flags in the group that match the tag of elt, that are EMPTY, and that are DELETED. Only
+ * the slots whose tag matches are compared, and if one is equal we have found the element and return its index.
+ * Otherwise, if the group has an EMPTY slot, the element is not in the array, and we return the first DELETED location we
+ * have seen, or that EMPTY location if there was none. Only the slots before the first EMPTY one count.
  * Runtime Expected/Worst: O(1)/O(n)
  */
-int search (SET *sp, void *elt, bool *found) {
-	int head = (*sp->hash)(elt)%sp->length;
-	int i, locn;
+static int search (SET *sp, void *elt, unsigned hash, bool *found) {
+	int locn = hash%sp->length;
+	char tag = tagOf(hash);
+	int i, j;
 	int deletedlocn=-1;
-	for (i = 0; i < sp->length; i++) {							// looping through the array
-		locn = (head + i)%sp->length;							// but now we start with the hash value.
-		if (sp->flags[locn] == FILLED) {						// FILLED means found, so return location/index
-			if ((sp->compare)(sp->data[locn],elt)==0){
+	unsigned match, empty, deleted, before;
+
+	for (i = 0; i < sp->length; i += GROUP) {					// looping through the array a group at a time
+		empty = matchMask(sp->flags + locn, EMPTY);
+		before = empty != 0 ? (empty & -empty) - 1 : 0xFFFF;	// the slots before the first EMPTY one
+		match = matchMask(sp->flags + locn, tag) & before;
+		while (match != 0) {									// same tag, so it is probably the element
+			j = (locn + __builtin_ctz(match))%sp->length;
+			if ((sp->compare)(sp->data[j],elt)==0){
 				*found = true;
-				return locn;
+				return j;
 			}
+			match &= match - 1;
 		}
-		else if (sp->flags[locn]==DELETED) {					// DELETED means it still could be further down in the array
-			if (deletedlocn==-1) {								// so we just remember the first DELETED location
-				deletedlocn = locn;
+		if (deletedlocn == -1) {								// DELETED means it still could be further down in the array
+			deleted = matchMask(sp->flags + locn, DELETED) & before;
+			if (deleted != 0) {									// so we just remember the first DELETED location
+				deletedlocn = (locn + __builtin_ctz(deleted))%sp->length;
 			}
 		}
-		else {													// must be EMPTY
-			break;
+		if (empty != 0) {										// EMPTY means it is not in the array
+			*found = false;
+			return deletedlocn != -1 ? deletedlocn : (locn + __builtin_ctz(empty))%sp->length;
 		}
+		locn = (locn + GROUP)%sp->length;
 	}
-	*found = false;												// we have not found the element
-	if (deletedlocn == -1) {									// so if we haven not seen a deleted location, return that new empty location at the end
-		return locn;
-	}
-	return deletedlocn;											// otherwise, return the first deleted location/index
+	*found = false;												// we have not found the element and there is no EMPTY slot
+	return deletedlocn;
 }
 
 /*
@@ -127,10 +188,12 @@ int search (SET *sp, void *elt, bool *found) {
 void addElement(SET *sp, void *elt){
 	assert(sp!=NULL && elt!=NULL);
 	bool searched;
-	int index = search(sp, elt, &searched);			// the index where the element should go
+	unsigned hash = (*sp->hash)(elt);
+	int index = search(sp, elt, hash, &searched);	// the index where the element should go
+	assert(searched || index >= 0);					// the set is full
 	if(searched==false) {
 		sp->data[index]=elt;						// we now set the data to the POINTER to the element (since its generic)
-		sp->flags[index] = FILLED;					// now we set the flag in the same index of the flags array to FILLED
+		setFlag(sp, index, tagOf(hash));			// now we set the flag in the same index of the flags array to FILLED
 		sp->count++;
 	}
 }
@@ -145,13 +208,38 @@ void addElement(SET *sp, void *elt){
 void removeElement(SET *sp, void *elt){
 	assert(sp!=NULL && elt!=NULL);
 	bool searched;
-	int index = search(sp, elt, &searched);			// index where the element should go
+	int index = search(sp, elt, (*sp->hash)(elt), &searched);	// index where the element should go
 	if(searched==true) {							// free the memory at index essentially deleting it
-		sp->flags[index] = DELETED;					// now we set the flag in the same index of the flags array to DELETED
+		setFlag(sp, index, DELETED);					// now we set the flag in the same index of the flags array to DELETED
 		sp->count--;
 	}
 }
 
+/*
+ * Function: *toggleElement
+ * ------------------------------------
+ * Summary: Removes the element if it is in the set and adds elt if not, with one search: when it misses, search has
+ * already found the spot where elt should go. Returns the element that was removed, for the caller to free, or NULL
+ * if elt was added.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void *toggleElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool searched;
+	unsigned hash = (*sp->hash)(elt);
+	int index = search(sp, elt, hash, &searched);
+	if(searched==true) {
+		setFlag(sp, index, DELETED);
+		sp->count--;
+		return sp->data[index];
+	}
+	assert(index >= 0);								// the set is full
+	sp->data[index]=elt;
+	setFlag(sp, index, tagOf(hash));
+	sp->count++;
+	return NULL;
+}
+
 /*
  * Function: *findElement
  * -------------------------------------
@@ -162,7 +250,7 @@ void removeElement(SET *sp, void *elt){
 void *findElement(SET *sp, void *elt){
 	assert(sp!=NULL && elt!=NULL);
 	bool searched;
-	int index = search(sp, elt, &searched);
+	int index = search(sp, elt, (*sp->hash)(elt), &searched);
 	if (searched==true){
 		return sp->data[index];
 	}
@@ -182,10 +270,42 @@ void *getElements(SET *sp){
 	int lastIndex = 0;
 	arr = malloc(sizeof(void*)*sp->count);		// declare array and allocate memory to be size of the number of elements
 	for (int i = 0;i < sp->length;i++){
-		if (sp->flags[i] == FILLED){				// we only want an array of elements and not the entire thing so check if FILLED
+		if (sp->flags[i] & FILLED){				// we only want an array of elements and not the entire thing so check if FILLED
 			arr[lastIndex]=sp->data[i];				// copy the data
 			lastIndex++;
 		}
 	}
 	return arr;
 }
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor before the first element so nextElement can walk the set in place,
+ * without the array getElements allocates. The set must not change while it is being walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->index = 0;
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the next element, or NULL when there are none left, by moving the cursor along to
+ * the next FILLED slot.
+ * Runtime: O(1) amortized
+ */
+void *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	SET *sp = cp->set;
+
+	while (cp->index < sp->length){
+		if (sp->flags[cp->index++] & FILLED){
+			return sp->data[cp->index-1];
+		}
+	}
+	return NULL;
+}
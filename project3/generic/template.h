@@ -0,0 +1,267 @@
+/*
+ * File:        template.h
+ *
+ * Description: This file contains a macro that generates a set for a
+ *              single element type.  The set works like the one in
+ *              table.c, probing control bytes a group at a time, but the
+ *              hash and equality functions are called directly instead of
+ *              through pointers, so the compiler can inline them into the
+ *              probing loop, and the elements are stored by value.
+ *
+ *              DEFINE_SET(P, TYPE, HASH, EQUAL) defines the types PSet and
+ *              PCursor and the functions PCreateSet, PDestroySet,
+ *              PNumElements, PAddElement, PRemoveElement, PToggleElement,
+ *              PFindElement, PGetElements, PBeginElements and
+ *              PNextElement, which work like those in set.h, except that
+ *              PToggleElement returns whether it added the element.
+ *              HASH(x) must return an unsigned hash of an element and
+ *              EQUAL(x, y) must be nonzero when two elements are equal;
+ *              both can be inline functions or macros.
+ *              PFindElement and PNextElement return a pointer to the copy
+ *              in the set, which stays where it is until it is removed, so
+ *              the parts of it that EQUAL does not look at can be updated
+ *              in place.  As in table.c, the set does not grow past the
+ *              maxElts elements it is created with.
+ *
+ *              The set in set.h stays for code that does not know the
+ *              type of its elements when it is compiled.
+ */
+
+# ifndef TEMPLATE_H
+# define TEMPLATE_H
+
+# include <stdlib.h>
+# include <stdbool.h>
+# include <assert.h>
+# ifdef __SSE2__
+# include <emmintrin.h>
+# endif
+
+# define TEMPLATE_EMPTY 0
+# define TEMPLATE_DELETED 1
+# define TEMPLATE_FILLED 0x80
+# define TEMPLATE_GROUP 16
+
+
+/*
+ * Function:    templateTag
+ *
+ * Description: Return the control byte for a slot holding an element with
+ *              the given HASH, as tagOf does in table.c.
+ */
+
+static inline char templateTag(unsigned hash)
+{
+    return TEMPLATE_FILLED | (hash * 0x9E3779B1u) >> 25;
+}
+
+
+/*
+ * Function:    templateMatch
+ *
+ * Description: Return a mask with bit i set if P[i] is FLAG, for the
+ *              TEMPLATE_GROUP control bytes at P.
+ */
+
+static inline unsigned templateMatch(char *p, char flag)
+{
+# ifdef __SSE2__
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) p),
+	_mm_set1_epi8(flag)));
+# else
+    unsigned mask = 0;
+    int i;
+
+    for (i = 0; i < TEMPLATE_GROUP; i ++)
+	mask |= (unsigned) (p[i] == flag) << i;
+
+    return mask;
+# endif
+}
+
+
+/*
+ * Function:    templateSetFlag
+ *
+ * Description: Set the control byte at LOCN in FLAGS, which has LENGTH
+ *              slots, and its copies past the end.
+ */
+
+static inline void templateSetFlag(char *flags, int length, int locn, char flag)
+{
+    int i;
+
+    flags[locn] = flag;
+
+    for (i = locn + length; i < length + TEMPLATE_GROUP; i += length)
+	flags[i] = flag;
+}
+
+
+/* The set itself.  Search is the search of table.c with EQUAL in place of
+   the compare function. */
+
+# define DEFINE_SET(P, TYPE, HASH, EQUAL)				      \
+									      \
+typedef struct P##Set {							      \
+    int count;				/* number of elements */	      \
+    int length;				/* length of the arrays */	      \
+    TYPE *data;				/* the elements */		      \
+    char *flags;			/* their control bytes */	      \
+} P##Set;								      \
+									      \
+typedef struct P##Cursor {						      \
+    P##Set *set;							      \
+    int index;								      \
+} P##Cursor;								      \
+									      \
+static inline P##Set *P##CreateSet(int maxElts)				      \
+{									      \
+    P##Set *sp = malloc(sizeof(P##Set));				      \
+									      \
+    assert(sp != NULL && maxElts > 0);					      \
+    sp->count = 0;							      \
+    sp->length = maxElts;						      \
+    sp->data = malloc(sizeof(TYPE) * maxElts);				      \
+    sp->flags = calloc(maxElts + TEMPLATE_GROUP, sizeof(char));		      \
+    assert(sp->data != NULL && sp->flags != NULL);			      \
+    return sp;								      \
+}									      \
+									      \
+static inline void P##DestroySet(P##Set *sp)				      \
+{									      \
+    free(sp->flags);							      \
+    free(sp->data);							      \
+    free(sp);								      \
+}									      \
+									      \
+static inline int P##NumElements(P##Set *sp)				      \
+{									      \
+    assert(sp != NULL);							      \
+    return sp->count;							      \
+}									      \
+									      \
+static inline int P##Search(P##Set *sp, TYPE *elt, unsigned hash,	      \
+    bool *found)							      \
+{									      \
+    int i, j, locn = hash % sp->length, deletedlocn = -1;		      \
+    unsigned match, empty, deleted, before;				      \
+    char tag = templateTag(hash);					      \
+									      \
+    for (i = 0; i < sp->length; i += TEMPLATE_GROUP) {			      \
+	empty = templateMatch(sp->flags + locn, TEMPLATE_EMPTY);	      \
+	before = empty != 0 ? (empty & -empty) - 1 : 0xFFFF;		      \
+	match = templateMatch(sp->flags + locn, tag) & before;		      \
+									      \
+	for (; match != 0; match &= match - 1) {			      \
+	    j = (locn + __builtin_ctz(match)) % sp->length;		      \
+									      \
+	    if (EQUAL(sp->data[j], *elt)) {				      \
+		*found = true;						      \
+		return j;						      \
+	    }								      \
+	}								      \
+									      \
+	if (deletedlocn == -1) {					      \
+	    deleted = templateMatch(sp->flags + locn, TEMPLATE_DELETED);      \
+									      \
+	    if ((deleted &= before) != 0)				      \
+		deletedlocn = (locn + __builtin_ctz(deleted)) % sp->length;   \
+	}								      \
+									      \
+	if (empty != 0) {						      \
+	    *found = false;						      \
+	    return deletedlocn != -1 ? deletedlocn :			      \
+		(locn + __builtin_ctz(empty)) % sp->length;		      \
+	}								      \
+									      \
+	locn = (locn + TEMPLATE_GROUP) % sp->length;			      \
+    }									      \
+									      \
+    *found = false;							      \
+    return deletedlocn;							      \
+}									      \
+									      \
+static inline void P##AddElement(P##Set *sp, TYPE elt)			      \
+{									      \
+    unsigned hash = HASH(elt);						      \
+    bool found;								      \
+    int locn = P##Search(sp, &elt, hash, &found);			      \
+									      \
+    assert(found || locn >= 0);						      \
+									      \
+    if (!found) {							      \
+	sp->data[locn] = elt;						      \
+	templateSetFlag(sp->flags, sp->length, locn, templateTag(hash));      \
+	sp->count ++;							      \
+    }									      \
+}									      \
+									      \
+static inline void P##RemoveElement(P##Set *sp, TYPE elt)		      \
+{									      \
+    bool found;								      \
+    int locn = P##Search(sp, &elt, HASH(elt), &found);			      \
+									      \
+    if (found) {							      \
+	templateSetFlag(sp->flags, sp->length, locn, TEMPLATE_DELETED);	      \
+	sp->count --;							      \
+    }									      \
+}									      \
+									      \
+static inline bool P##ToggleElement(P##Set *sp, TYPE elt)		      \
+{									      \
+    unsigned hash = HASH(elt);						      \
+    bool found;								      \
+    int locn = P##Search(sp, &elt, hash, &found);			      \
+									      \
+    if (found) {							      \
+	templateSetFlag(sp->flags, sp->length, locn, TEMPLATE_DELETED);	      \
+	sp->count --;							      \
+    } else {								      \
+	assert(locn >= 0);						      \
+	sp->data[locn] = elt;						      \
+	templateSetFlag(sp->flags, sp->length, locn, templateTag(hash));      \
+	sp->count ++;							      \
+    }									      \
+									      \
+    return !found;							      \
+}									      \
+									      \
+static inline TYPE *P##FindElement(P##Set *sp, TYPE elt)		      \
+{									      \
+    bool found;								      \
+    int locn = P##Search(sp, &elt, HASH(elt), &found);			      \
+									      \
+    return found ? &sp->data[locn] : NULL;				      \
+}									      \
+									      \
+static inline TYPE *P##GetElements(P##Set *sp)				      \
+{									      \
+    TYPE *elts = malloc(sizeof(TYPE) * (sp->count > 0 ? sp->count : 1));      \
+    int i, n = 0;							      \
+									      \
+    assert(elts != NULL);						      \
+									      \
+    for (i = 0; i < sp->length; i ++)					      \
+	if (sp->flags[i] & TEMPLATE_FILLED)				      \
+	    elts[n ++] = sp->data[i];					      \
+									      \
+    return elts;							      \
+}									      \
+									      \
+static inline void P##BeginElements(P##Set *sp, P##Cursor *cp)		      \
+{									      \
+    cp->set = sp;							      \
+    cp->index = 0;							      \
+}									      \
+									      \
+static inline TYPE *P##NextElement(P##Cursor *cp)			      \
+{									      \
+    while (cp->index < cp->set->length)					      \
+	if (cp->set->flags[cp->index ++] & TEMPLATE_FILLED)		      \
+	    return &cp->set->data[cp->index - 1];			      \
+									      \
+    return NULL;							      \
+}
+
+# endif /* TEMPLATE_H */
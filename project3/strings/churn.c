@@ -0,0 +1,103 @@
+/*
+ * File:        churn.c
+ *
+ * Description: This file contains a benchmark for the probe lengths of
+ *              the Robin Hood set under removals.
+ *
+ *              The program loads the distinct words of a file into the
+ *              set and then runs a number of rounds, each of which removes
+ *              half of the words and adds them back, as parity does.  The
+ *              average and longest number of slots a successful search
+ *              looks at (see robin.h) are printed after loading and after
+ *              each round, along with the time the round took.  With
+ *              backward-shift deletion there are no tombstones, so the
+ *              probe lengths should not grow from one round to the next.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <time.h>
+# include "robin.h"
+# include "words.h"
+
+
+/* The default number of rounds. */
+
+# define ROUNDS 10
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    char buffer[BUFSIZ], **words, *elt;
+    int i, n, round, rounds;
+    CURSOR cursor;
+    clock_t start;
+    WORDS *wp;
+    SET *sp;
+
+
+    /* Check usage and load the distinct words. */
+
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s file [rounds]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    rounds = argc > 2 ? atoi(argv[2]) : ROUNDS;
+
+    if ((wp = openWords(argv[1])) == NULL) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+        exit(EXIT_FAILURE);
+    }
+
+    sp = createSet(0);
+
+    while (readWord(wp, buffer, BUFSIZ) == 1)
+        addElement(sp, buffer);
+
+    closeWords(wp);
+
+
+    /* Keep copies of the words, since removing them frees the set's. */
+
+    n = numElements(sp);
+    words = malloc(sizeof(char *) * (n > 0 ? n : 1));
+    beginElements(sp, &cursor);
+
+    for (i = 0; (elt = nextElement(&cursor)) != NULL; i ++)
+        words[i] = strdup(elt);
+
+    printf("%d words\n", n);
+    printf("%-6s %8s %5s %8s\n", "round", "avg", "max", "time");
+    printf("%-6s %8.3f %5d\n", "load", averageProbe(sp), maxProbe(sp));
+
+
+    /* Remove half of the words and add them back, alternating halves. */
+
+    for (round = 1; round <= rounds; round ++) {
+        start = clock();
+
+        for (i = round % 2; i < n; i += 2)
+            removeElement(sp, words[i]);
+
+        for (i = round % 2; i < n; i += 2)
+            addElement(sp, words[i]);
+
+        printf("%-6d %8.3f %5d %7.3fs\n", round, averageProbe(sp),
+            maxProbe(sp), (double) (clock() - start) / CLOCKS_PER_SEC);
+    }
+
+    for (i = 0; i < n; i ++)
+        free(words[i]);
+
+    free(words);
+    destroySet(sp);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,780 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+#define SLOTS 4
+#define STASH 2
+#define LINE 64
+#define MAX_KICKS 500
+#define BATCH 16
+#define MAX_LOAD 90
+#define MIN_LOAD 20
+#define MIN_LENGTH 4
+#define SECOND_SEED 0x9E3779B97F4A7C15UL
+#define MAGIC "cuckoo1"
+#define ORDER 0x01020304
+#define ALIGN(n) (((n) + LINE - 1) & ~(size_t) (LINE - 1))
+
+/*
+ * This file implements the same set as table.c with bucketized cuckoo hashing. Every element has two
+ * buckets, one from each of two hash functions (the set's hash function with two different seeds), and
+ * is always in one of them. A bucket is SLOTS slots that fill exactly one LINE byte cache line, so a
+ * search looks at no more than two cache lines however full the table is, and only calls strcmp on a
+ * slot whose stored first hash matches. Adding an element to two full buckets evicts one of the
+ * elements in the way to its other bucket, which may evict another, and so on. After MAX_KICKS of these
+ * the element left over goes into the stash, STASH more buckets that are only searched while they hold
+ * something. When the stash is full too the table doubles. The buckets go up to MAX_LOAD percent full
+ * (details are commented above each function). A snapshot file (see saveSet) is a header, the buckets
+ * with one more than the offset of each string in place of its pointer, and then the strings.
+ */
+struct bucket
+{
+	unsigned first[SLOTS]; /*first hash of each element */
+	unsigned second[SLOTS]; /*and its second hash, so it can be moved without hashing it again */
+	char *data[SLOTS]; /*the elements, NULL for an empty slot */
+};
+
+struct set
+{
+	int count;	/*number of elements */
+	int length; /*number of buckets, a power of two, not counting the stash */
+	int stashed; /*number of elements in the stash */
+	struct bucket *buckets; /*the buckets, followed by the STASH buckets of the stash */
+	unsigned kick; /*which slot of a full bucket to evict next */
+	HASHFUNC hash; /*the hash function for the strings */
+	unsigned long seed; /*and the seed it is given */
+	uintptr_t base; /*added to each slot: 0, or just before where the strings of a snapshot are */
+	bool frozen; /*whether the buckets are still in the snapshot, which cannot be changed */
+	void *mapping; /*the snapshot file, if the set was loaded from one */
+	size_t mapsize; /*and its size */
+};
+typedef struct set SET;
+
+struct header
+{
+	char magic[8]; /*MAGIC, to tell a snapshot from any other file */
+	int order; /*ORDER, as the machine that saved it stores it */
+	int count; /*number of elements */
+	int length; /*number of buckets */
+	int stashed; /*number of elements in the stash */
+	char hash[8]; /*name of the hash function (see hashName) */
+	unsigned long seed; /*and its seed */
+	size_t strings; /*bytes of the strings */
+};
+
+/*
+ * Function: firstHash
+ * -------------------------------
+ * Summary: Hashes a string of the given length with the first hash function.
+ * Runtime: O(length of the string)
+ */
+static inline unsigned firstHash(SET *sp, char *s, size_t len) {
+	return (*sp->hash)(s, len, sp->seed);
+}
+
+/*
+ * Function: secondHash
+ * -------------------------------
+ * Summary: Hashes a string of the given length with the second hash function, which is the first with a different seed.
+ * Runtime: O(length of the string)
+ */
+static inline unsigned secondHash(SET *sp, char *s, size_t len) {
+	return (*sp->hash)(s, len, sp->seed ^ SECOND_SEED);
+}
+
+/*
+ * Function: *keyOf
+ * -------------------------------
+ * Summary: Returns the string in slot i of a bucket.
+ * Runtime: O(1)
+ */
+static inline char *keyOf(SET *sp, struct bucket *bp, int i) {
+	return (char *) (sp->base + (uintptr_t) bp->data[i]);
+}
+
+/*
+ * Function: allocate
+ * -------------------------------
+ * Summary: Gives the set the given number of empty buckets and an empty stash, aligned to cache lines.
+ * Runtime: O(n)
+ */
+static void allocate(SET *sp, int length) {
+	sp->length = length;
+	sp->stashed = 0;
+	sp->buckets = aligned_alloc(LINE, ALIGN(sizeof(struct bucket)*(length+STASH)));
+	assert(sp->buckets!=NULL);
+	memset(sp->buckets, 0, sizeof(struct bucket)*(length+STASH));	// every slot starts out NULL
+}
+
+/*
+ * Function: *createHashedSet
+ * -------------------------------
+ * Summary: Allocates the set with the fewest buckets (a power of two) that hold maxElts elements under MAX_LOAD,
+ * hashing with the given hash function and seed. As in table.c, maxElts is only a hint and the table grows when it
+ * needs to.
+ * Runtime: O(n)
+ */
+SET *createHashedSet(int maxElts, HASHFUNC hash, unsigned long seed){
+	SET *sp;
+	int length = MIN_LENGTH;
+
+	sp=malloc(sizeof(SET));
+	assert(sp!=NULL);
+
+	while ((long) length*SLOTS*MAX_LOAD < (long) maxElts*100) {
+		length *= 2;
+	}
+	sp->count = 0;
+	sp->kick = 0;
+	sp->hash = hash;
+	sp->seed = seed;
+	sp->base = 0;
+	sp->frozen = false;
+	sp->mapping = NULL;
+	sp->mapsize = 0;
+	allocate(sp, length);
+	return sp;
+}
+
+/*
+ * Function: *createSet
+ * -------------------------------
+ * Summary: Creates a set that hashes with wyHash and a seed of zero, like table.c.
+ * Runtime: O(n)
+ */
+SET *createSet(int maxElts){
+	return createHashedSet(maxElts, wyHash, 0);
+}
+
+/*
+ * Function: destroySet
+ * --------------------------------
+ * Summary: Frees every element, the buckets, and then the set. If the set was loaded from a snapshot, the file is
+ * unmapped.
+ * Runtime: O(n)
+ */
+void destroySet(SET *sp){
+	int b, i;
+
+	if (!sp->frozen) {
+		for (b=0;b<sp->length+STASH;b++){
+			for (i=0;i<SLOTS;i++){
+				free(sp->buckets[b].data[i]);
+			}
+		}
+		free(sp->buckets);
+	}
+	if (sp->mapping != NULL) {
+		munmap(sp->mapping, sp->mapsize);
+	}
+	free(sp);
+}
+
+/*
+ * Function: numElements
+ * ----------------------------------
+ * Summary: Simply returns the number of elements in the set
+ * Runtime: O(1)
+ */
+int numElements(SET *sp){
+	assert(sp!=NULL);
+	return sp->count;
+}
+
+/*
+ * Function: lookup
+ * ------------------------------------
+ * Summary: Returns the slot of a bucket that holds elt, or -1 if none does. The first hashes are compared first,
+ * so strcmp is only called on a likely match.
+ * Runtime: O(1)
+ */
+static inline int lookup(SET *sp, struct bucket *bp, char *elt, unsigned first) {
+	int i;
+
+	for (i = 0; i < SLOTS; i++) {
+		if (bp->data[i] != NULL && bp->first[i] == first && strcmp(keyOf(sp, bp, i), elt) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Function: *search
+ * ------------------------------------
+ * Summary: Looks for elt in its first bucket, then its second, and then the stash if anything is in it. Returns
+ * the bucket it is in and stores its slot in *slot, or returns NULL. The second hash is only computed if the first
+ * bucket does not have elt; it is stored in *second whenever NULL is returned, since an add needs it.
+ * Runtime: O(1)
+ */
+static struct bucket *search(SET *sp, char *elt, size_t len, unsigned first, unsigned *second, int *slot) {
+	struct bucket *bp = &sp->buckets[first & (sp->length-1)];
+	int b;
+
+	if ((*slot = lookup(sp, bp, elt, first)) >= 0) {
+		return bp;
+	}
+	*second = secondHash(sp, elt, len);
+	bp = &sp->buckets[*second & (sp->length-1)];
+	if ((*slot = lookup(sp, bp, elt, first)) >= 0) {
+		return bp;
+	}
+	for (b = 0; sp->stashed > 0 && b < STASH; b++) {
+		bp = &sp->buckets[sp->length + b];
+		if ((*slot = lookup(sp, bp, elt, first)) >= 0) {
+			return bp;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Function: put
+ * ------------------------------------
+ * Summary: Puts an element in the first empty slot of a bucket and returns true, or returns false if it is full.
+ * Runtime: O(1)
+ */
+static inline bool put(struct bucket *bp, char *elt, unsigned first, unsigned second) {
+	int i;
+
+	for (i = 0; i < SLOTS; i++) {
+		if (bp->data[i] == NULL) {
+			bp->data[i] = elt;
+			bp->first[i] = first;
+			bp->second[i] = second;
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Function: place
+ * ------------------------------------
+ * Summary: Puts an element that is not in the set into it. If both its buckets are full, it takes a slot in its
+ * second bucket and the element that was there is carried to its own other bucket, and so on, for up to MAX_KICKS
+ * evictions. The element still being carried after that goes into the stash. If the stash is full too, false is
+ * returned with that element (which need not be the one we started with) and its hashes back in *eltp, *firstp
+ * and *secondp, so the caller can grow the table and try again.
+ * Runtime Expected/Worst: O(1)/O(MAX_KICKS)
+ */
+static bool place(SET *sp, char **eltp, unsigned *firstp, unsigned *secondp) {
+	char *elt = *eltp, *tmp;
+	unsigned first = *firstp, second = *secondp, mask = sp->length-1, tmphash;
+	struct bucket *bp;
+	int b, i, kicks, locn;
+
+	if (put(&sp->buckets[first & mask], elt, first, second)) {
+		return true;
+	}
+	locn = second & mask;
+	for (kicks = 0; kicks < MAX_KICKS; kicks++) {
+		bp = &sp->buckets[locn];
+		if (put(bp, elt, first, second)) {
+			return true;
+		}
+		i = sp->kick++ % SLOTS;						// take a slot and carry its element on instead
+		tmp = bp->data[i];
+		bp->data[i] = elt;
+		elt = tmp;
+		tmphash = bp->first[i];
+		bp->first[i] = first;
+		first = tmphash;
+		tmphash = bp->second[i];
+		bp->second[i] = second;
+		second = tmphash;
+		locn = (first & mask) == locn ? second & mask : first & mask;
+	}
+	for (b = 0; b < STASH; b++) {
+		if (put(&sp->buckets[sp->length + b], elt, first, second)) {
+			sp->stashed++;
+			return true;
+		}
+	}
+	*eltp = elt;
+	*firstp = first;
+	*secondp = second;
+	return false;
+}
+
+/*
+ * Function: rehash
+ * ------------------------------------
+ * Summary: Moves every element, stash and all, into new buckets of the given number. The stored hashes are used so
+ * no string is hashed again. If the elements somehow do not fit, we start over with twice as many buckets.
+ * Runtime: O(n)
+ */
+static void rehash(SET *sp, int length) {
+	struct bucket *buckets = sp->buckets;
+	int b, i, oldlength = sp->length;
+	unsigned first, second;
+	bool fits;
+	char *elt;
+
+	do {
+		allocate(sp, length);
+		fits = true;
+		for (b = 0; fits && b < oldlength+STASH; b++) {
+			for (i = 0; fits && i < SLOTS; i++) {
+				if ((elt = buckets[b].data[i]) != NULL) {
+					first = buckets[b].first[i];
+					second = buckets[b].second[i];
+					fits = place(sp, &elt, &first, &second);
+				}
+			}
+		}
+		if (!fits) {
+			free(sp->buckets);
+			length *= 2;
+		}
+	} while (!fits);
+	free(buckets);
+}
+
+/*
+ * Function: unstash
+ * ------------------------------------
+ * Summary: Called when a slot of a bucket is freed. If an element in the stash has this bucket as one of its own,
+ * it is moved into the slot, so the stash empties out again as elements are removed.
+ * Runtime: O(1)
+ */
+static void unstash(SET *sp, struct bucket *bp, int slot) {
+	struct bucket *sb;
+	unsigned mask = sp->length-1;
+	int b, i, locn = bp - sp->buckets;
+
+	for (b = 0; sp->stashed > 0 && b < STASH; b++) {
+		sb = &sp->buckets[sp->length + b];
+		for (i = 0; i < SLOTS; i++) {
+			if (sb->data[i] != NULL && ((sb->first[i] & mask) == locn || (sb->second[i] & mask) == locn)) {
+				bp->data[slot] = sb->data[i];
+				bp->first[slot] = sb->first[i];
+				bp->second[slot] = sb->second[i];
+				sb->data[i] = NULL;
+				sp->stashed--;
+				return;
+			}
+		}
+	}
+}
+
+/*
+ * Function: thaw
+ * ------------------------------------
+ * Summary: Called before the first change to a set loaded from a snapshot. The buckets are copied out of the file
+ * and every string is copied too, since the set frees its strings when they are removed.
+ * Runtime: O(n)
+ */
+static void thaw(SET *sp) {
+	struct bucket *buckets = sp->buckets;
+	int b, i;
+
+	sp->buckets = aligned_alloc(LINE, ALIGN(sizeof(struct bucket)*(sp->length+STASH)));
+	assert(sp->buckets!=NULL);
+	memcpy(sp->buckets, buckets, sizeof(struct bucket)*(sp->length+STASH));
+	for (b = 0; b < sp->length+STASH; b++) {
+		for (i = 0; i < SLOTS; i++) {
+			if (buckets[b].data[i] != NULL) {
+				sp->buckets[b].data[i] = strdup(keyOf(sp, &buckets[b], i));
+				assert(sp->buckets[b].data[i]!=NULL);
+			}
+		}
+	}
+	sp->base = 0;
+	sp->frozen = false;
+}
+
+/*
+ * Function: insert
+ * -------------------------------------
+ * Summary: Places a copy of an element that a search did not find, with the hashes the search computed, doubling
+ * the table first if it would go over MAX_LOAD, and again whenever place cannot find room for the element it is
+ * left holding.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void insert(SET *sp, char *elt, unsigned first, unsigned second){
+	if ((long) (sp->count+1)*100 > (long) sp->length*SLOTS*MAX_LOAD) {
+		rehash(sp, sp->length*2);
+	}
+	elt = strdup(elt);
+	assert(elt!=NULL);
+	while (!place(sp, &elt, &first, &second)) {
+		rehash(sp, sp->length*2);
+	}
+	sp->count++;
+}
+
+/*
+ * Function: removeAt
+ * ------------------------------------
+ * Summary: Frees the element in a slot of a bucket and empties the slot, and an element waiting in the stash for
+ * that bucket takes the slot. If the set falls under MIN_LOAD it is halved.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void removeAt(SET *sp, struct bucket *bp, int slot){
+	free(bp->data[slot]);
+	bp->data[slot] = NULL;
+	sp->count--;
+	if (bp >= &sp->buckets[sp->length]) {
+		sp->stashed--;
+	}
+	else {
+		unstash(sp, bp, slot);
+	}
+	if ((long) sp->count*100 < (long) sp->length*SLOTS*MIN_LOAD && sp->length/2 >= MIN_LENGTH) {
+		rehash(sp, sp->length/2);
+	}
+}
+
+/*
+ * Function: addElement
+ * -------------------------------------
+ * Summary: If elt is not in the set, a copy is inserted.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void addElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	size_t len = strlen(elt);
+	unsigned first = firstHash(sp, elt, len), second;
+	int slot;
+
+	if (sp->frozen) {
+		thaw(sp);
+	}
+	if (search(sp, elt, len, first, &second, &slot) == NULL) {
+		insert(sp, elt, first, second);
+	}
+}
+
+/*
+ * Function: removeElement
+ * ------------------------------------
+ * Summary: If elt is found, it is removed with removeAt.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void removeElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	struct bucket *bp;
+	unsigned second;
+	size_t len;
+	int slot;
+
+	if (sp->frozen) {
+		thaw(sp);
+	}
+	len = strlen(elt);
+	bp = search(sp, elt, len, firstHash(sp, elt, len), &second, &slot);
+	if (bp != NULL) {
+		removeAt(sp, bp, slot);
+	}
+}
+
+/*
+ * Function: toggle
+ * ------------------------------------
+ * Summary: Removes elt if it is in the set and inserts it if not, given its length and first hash. A search that
+ * misses has already computed the second hash, so the insert starts straight away. Returns whether elt was added.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static bool toggle(SET *sp, char *elt, size_t len, unsigned first){
+	struct bucket *bp;
+	unsigned second;
+	int slot;
+
+	if (sp->frozen) {
+		thaw(sp);
+	}
+	bp = search(sp, elt, len, first, &second, &slot);
+	if (bp != NULL) {
+		removeAt(sp, bp, slot);
+	}
+	else {
+		insert(sp, elt, first, second);
+	}
+	return bp == NULL;
+}
+
+/*
+ * Function: toggleElement
+ * ------------------------------------
+ * Summary: Hashes elt and toggles it (see toggle). Returns whether elt was added.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+bool toggleElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	size_t len = strlen(elt);
+	return toggle(sp, elt, len, firstHash(sp, elt, len));
+}
+
+/*
+ * Function: *findElement
+ * -------------------------------------
+ * Summary: Returns the matching element, or NULL if there is none.
+ * Runtime: O(1)
+ */
+char *findElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	struct bucket *bp;
+	unsigned second;
+	size_t len = strlen(elt);
+	int slot;
+
+	bp = search(sp, elt, len, firstHash(sp, elt, len), &second, &slot);
+	return bp != NULL ? keyOf(sp, bp, slot) : NULL;
+}
+
+/*
+ * Function: findElements
+ * -------------------------------------
+ * Summary: Looks up n elements at once and stores the match for each (or NULL) in results. As in table.c, they are
+ * taken BATCH at a time. Both hashes of every element of a batch are computed and both its buckets prefetched before
+ * any is searched, so a batch costs about one round of cache misses instead of one or two per element.
+ * Runtime: O(n)
+ */
+void findElements(SET *sp, char **elts, int n, char **results){
+	assert(sp!=NULL && (n==0 || (elts!=NULL && results!=NULL)));
+	unsigned first[BATCH], second[BATCH], mask = sp->length-1;
+	struct bucket *bp;
+	int b, i, j, m, slot;
+	size_t len;
+
+	for (i = 0; i < n; i += BATCH) {
+		m = n - i < BATCH ? n - i : BATCH;
+		for (j = 0; j < m; j++) {
+			len = strlen(elts[i+j]);
+			first[j] = firstHash(sp, elts[i+j], len);
+			second[j] = secondHash(sp, elts[i+j], len);
+			__builtin_prefetch(&sp->buckets[first[j] & mask]);
+			__builtin_prefetch(&sp->buckets[second[j] & mask]);
+		}
+		for (j = 0; j < m; j++) {
+			bp = &sp->buckets[first[j] & mask];
+			if ((slot = lookup(sp, bp, elts[i+j], first[j])) < 0) {
+				bp = &sp->buckets[second[j] & mask];
+				slot = lookup(sp, bp, elts[i+j], first[j]);
+			}
+			for (b = 0; slot < 0 && sp->stashed > 0 && b < STASH; b++) {
+				bp = &sp->buckets[sp->length + b];
+				slot = lookup(sp, bp, elts[i+j], first[j]);
+			}
+			results[i+j] = slot >= 0 ? keyOf(sp, bp, slot) : NULL;
+		}
+	}
+}
+
+/*
+ * Function: toggleElements
+ * -------------------------------------
+ * Summary: Toggles n elements in order and stores whether each was added in added (if it is not NULL). As in
+ * findElements, both buckets of every element of a BATCH are prefetched before any is toggled.
+ * Runtime Expected/Worst: O(n)/O(n * length of array)
+ */
+void toggleElements(SET *sp, char **elts, int n, bool *added){
+	assert(sp!=NULL && (n==0 || elts!=NULL));
+	unsigned first[BATCH], mask;
+	size_t lens[BATCH];
+	int i, j, m;
+	bool result;
+
+	for (i = 0; i < n; i += BATCH) {
+		m = n - i < BATCH ? n - i : BATCH;
+		mask = sp->length-1;							// the last batch may have resized the table
+		for (j = 0; j < m; j++) {
+			lens[j] = strlen(elts[i+j]);
+			first[j] = firstHash(sp, elts[i+j], lens[j]);
+			__builtin_prefetch(&sp->buckets[first[j] & mask]);
+			__builtin_prefetch(&sp->buckets[secondHash(sp, elts[i+j], lens[j]) & mask]);
+		}
+		for (j = 0; j < m; j++) {
+			result = toggle(sp, elts[i+j], lens[j], first[j]);
+			if (added != NULL) {
+				added[i+j] = result;
+			}
+		}
+	}
+}
+
+/*
+ * Function: **getElements
+ * ----------------------------------
+ * Summary: getElements returns a copy of the array for the user to play with
+ * Runtime: O(n)
+ */
+char **getElements(SET *sp){
+	assert(sp!=NULL);
+	char **arr, *elt;
+	int lastIndex = 0;
+	CURSOR cursor;
+
+	arr = malloc(sizeof(char*)*sp->count);
+	beginElements(sp, &cursor);
+	while ((elt = nextElement(&cursor)) != NULL){
+		arr[lastIndex++] = strdup(elt);
+	}
+	return arr;
+}
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor before the first element. The set must not change while it is being walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->index = 0;
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the element in the next full slot, going through the buckets and then the stash, or NULL when
+ * there are none left.
+ * Runtime: O(1) amortized
+ */
+char *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	SET *sp = cp->set;
+	struct bucket *bp;
+	int i;
+
+	while (cp->index < (sp->length+STASH)*SLOTS){
+		bp = &sp->buckets[cp->index / SLOTS];
+		i = cp->index++ % SLOTS;
+		if (bp->data[i] != NULL){
+			return keyOf(sp, bp, i);
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Function: saveSet
+ * ----------------------------------
+ * Summary: Writes the set to a snapshot file that loadSet can map back in: a header, the buckets with one more than
+ * the offset of each string in place of its pointer (so an empty slot is still NULL), and then the strings packed
+ * one after another in slot order. The file is written under a temporary name and then renamed, so a set loaded
+ * from the old file (even this one) keeps working and nobody can load half a snapshot. Returns 0 if the file cannot
+ * be written or the hash function has no name (see hashName), and 1 otherwise.
+ * Runtime: O(n)
+ */
+int saveSet(SET *sp, char *path){
+	assert(sp!=NULL && path!=NULL);
+	static char padding[LINE];
+	struct header header;
+	struct bucket bucket;
+	size_t offset = 1;
+	char temp[strlen(path) + 5], *name;
+	FILE *fp;
+	int b, i, failed;
+
+	if ((name = hashName(sp->hash)) == NULL || (fp = fopen(strcat(strcpy(temp, path), ".tmp"), "wb")) == NULL){
+		return 0;
+	}
+	memset(&header, 0, sizeof(header));
+	strcpy(header.magic, MAGIC);
+	header.order = ORDER;
+	header.count = sp->count;
+	header.length = sp->length;
+	header.stashed = sp->stashed;
+	strcpy(header.hash, name);
+	header.seed = sp->seed;
+	for (b=0;b<sp->length+STASH;b++){
+		for (i=0;i<SLOTS;i++){
+			if (sp->buckets[b].data[i] != NULL){
+				header.strings += strlen(keyOf(sp, &sp->buckets[b], i)) + 1;
+			}
+		}
+	}
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(padding, ALIGN(sizeof(header)) - sizeof(header), 1, fp);
+
+	for (b=0;b<sp->length+STASH;b++){
+		bucket = sp->buckets[b];
+		for (i=0;i<SLOTS;i++){
+			if (bucket.data[i] != NULL){
+				bucket.data[i] = (char *) offset;
+				offset += strlen(keyOf(sp, &sp->buckets[b], i)) + 1;
+			}
+		}
+		fwrite(&bucket, sizeof(bucket), 1, fp);
+	}
+
+	for (b=0;b<sp->length+STASH;b++){
+		for (i=0;i<SLOTS;i++){
+			if (sp->buckets[b].data[i] != NULL){
+				fwrite(keyOf(sp, &sp->buckets[b], i), strlen(keyOf(sp, &sp->buckets[b], i)) + 1, 1, fp);
+			}
+		}
+	}
+	failed = ferror(fp);
+	if (fclose(fp) != 0 || failed || rename(temp, path) != 0){
+		remove(temp);
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Function: *loadSet
+ * ----------------------------------
+ * Summary: Maps a snapshot file written by saveSet into memory and returns a set whose buckets are the ones in the
+ * file, so nothing is read until it is searched. Returns NULL if the file cannot be opened or is not a snapshot from
+ * this implementation on this kind of machine. The contents of the buckets are trusted.
+ * Runtime: O(1)
+ */
+SET *loadSet(char *path){
+	assert(path!=NULL);
+	struct header *hp;
+	struct stat st;
+	char *mapping;
+	size_t buckets, strings;
+	SET *sp;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) < 0){
+		return NULL;
+	}
+	mapping = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= sizeof(struct header)){
+		mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if (mapping == MAP_FAILED){
+		return NULL;
+	}
+
+	hp = (struct header *) mapping;
+	buckets = ALIGN(sizeof(struct header));
+	strings = buckets + sizeof(struct bucket)*((size_t) hp->length+STASH);
+	if (memcmp(hp->magic, MAGIC, sizeof(MAGIC)) != 0 || hp->order != ORDER || hp->length < MIN_LENGTH ||
+			(hp->length & (hp->length-1)) != 0 || hp->hash[sizeof(hp->hash)-1] != '\0' || findHash(hp->hash) == NULL ||
+			strings + hp->strings != st.st_size){
+		munmap(mapping, st.st_size);
+		return NULL;
+	}
+	madvise(mapping, st.st_size, MADV_RANDOM);		// searches jump all over the table
+
+	sp = malloc(sizeof(SET));
+	assert(sp!=NULL);
+	sp->count = hp->count;
+	sp->length = hp->length;
+	sp->stashed = hp->stashed;
+	sp->buckets = (struct bucket *) (mapping + buckets);
+	sp->kick = 0;
+	sp->hash = findHash(hp->hash);
+	sp->seed = hp->seed;
+	sp->base = (uintptr_t) (mapping + strings - 1);	// the offsets start at one
+	sp->frozen = true;
+	sp->mapping = mapping;
+	sp->mapsize = st.st_size;
+	return sp;
+}
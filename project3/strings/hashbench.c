@@ -0,0 +1,204 @@
+/*
+ * File:        hashbench.c
+ *
+ * Description: This file contains a benchmark for the hash functions in
+ *              hash.h.
+ *
+ *              The program collects the distinct words of the files given
+ *              as command line arguments.  For each hash function, it times
+ *              hashing all of them, and it puts them into a linear probing
+ *              table like the one in table.c to see how many slots a search
+ *              for each word has to look at.  The throughput and the
+ *              distribution of the probe lengths are printed.  With -s the
+ *              hash functions are given a random seed instead of zero, and
+ *              with -l the table is filled to the given percentage instead
+ *              of the 50% that table.c keeps it under.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <unistd.h>
+# include <time.h>
+# include "set.h"
+# include "words.h"
+
+
+/* How many bytes to hash for the timing, and the buckets of the
+   probe length histogram (the last one is open ended). */
+
+# define BYTES (64 << 20)
+# define LOAD 50
+
+static int buckets[] = {1, 2, 4, 8, 16};
+
+# define BUCKETS (sizeof(buckets) / sizeof(buckets[0]))
+
+
+/*
+ * Function:    probes
+ *
+ * Description: Insert N words with lengths LENS into a linear probing
+ *              table of LENGTH slots, hashing with HASH and SEED, and add
+ *              the number of slots looked at for each to HISTOGRAM.  The
+ *              total is returned and the longest is stored in *MAXP.
+ */
+
+static long probes(char **words, size_t *lens, int n, HASHFUNC hash,
+    unsigned long seed, int length, long *histogram, int *maxp)
+{
+    char *used = calloc(length, sizeof(char));
+    long total = 0;
+    int i, j, locn;
+
+
+    *maxp = 0;
+
+    for (i = 0; i < n; i ++) {
+        locn = (*hash)(words[i], lens[i], seed) % length;
+
+        for (j = 1; used[locn]; j ++)
+            locn = (locn + 1) % length;
+
+        used[locn] = 1;
+        total += j;
+
+        if (j > *maxp)
+            *maxp = j;
+
+        for (locn = 0; locn < BUCKETS && j > buckets[locn]; locn ++)
+            ;
+
+        histogram[locn] ++;
+    }
+
+    free(used);
+    return total;
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    static char *names[] = {"str", "fnv", "word", "wy"};
+    char buffer[BUFSIZ], **words, *elt;
+    int i, j, n, c, rounds, load, max, length;
+    long histogram[BUCKETS + 1], total;
+    unsigned long seed;
+    volatile unsigned sink;	/* so the hashing is not optimized away */
+    size_t *lens, bytes;
+    HASHFUNC hash;
+    CURSOR cursor;
+    clock_t start;
+    double secs;
+    WORDS *wp;
+    SET *sp;
+
+
+    /* Check usage and collect the distinct words. */
+
+    seed = 0;
+    load = LOAD;
+
+    while ((c = getopt(argc, argv, "sl:")) != -1)
+        switch (c) {
+        case 's':
+            seed = randomSeed();
+            break;
+
+        case 'l':
+            load = atoi(optarg);
+            break;
+
+        default:
+            optind = argc + 1;
+        }
+
+    if (optind >= argc || load < 1 || load > 100) {
+        fprintf(stderr, "usage: %s [-s] [-l load] file ...\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    sp = createSet(0);
+
+    for (i = optind; i < argc; i ++) {
+        if ((wp = openWords(argv[i])) == NULL) {
+            fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[i]);
+            exit(EXIT_FAILURE);
+        }
+
+        while (readWord(wp, buffer, BUFSIZ) == 1)
+            addElement(sp, buffer);
+
+        closeWords(wp);
+    }
+
+    if ((n = numElements(sp)) == 0) {
+        fprintf(stderr, "%s: no words\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    words = malloc(sizeof(char *) * n);
+    lens = malloc(sizeof(size_t) * n);
+    bytes = 0;
+    beginElements(sp, &cursor);
+
+    for (i = 0; (elt = nextElement(&cursor)) != NULL; i ++) {
+        words[i] = elt;
+        lens[i] = strlen(elt);
+        bytes += lens[i];
+    }
+
+
+    /* Time and tabulate each hash function. */
+
+    length = (long) n * 100 / load;
+    length = length < n ? n : length;
+    rounds = bytes < BYTES ? BYTES / bytes : 1;
+
+    printf("%d words, %zu bytes, %d slots (%d%% full), seed %lx\n",
+        n, bytes, length, n * 100 / length, seed);
+    printf("%-5s %8s %8s %6s %5s", "hash", "Mhash/s", "MB/s", "avg", "max");
+
+    for (i = 0; i < BUCKETS; i ++)
+        if (i == 0 || buckets[i] == buckets[i - 1] + 1)
+            printf(" %6d", buckets[i]);
+        else
+            printf(" %3d-%-2d", buckets[i - 1] + 1, buckets[i]);
+
+    printf(" %5d+\n", buckets[BUCKETS - 1] + 1);
+
+    for (c = 0; c < sizeof(names) / sizeof(names[0]); c ++) {
+        hash = findHash(names[c]);
+        sink = 0;
+        start = clock();
+
+        for (j = 0; j < rounds; j ++)
+            for (i = 0; i < n; i ++)
+                sink += (*hash)(words[i], lens[i], seed);
+
+        secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+        memset(histogram, 0, sizeof(histogram));
+        total = probes(words, lens, n, hash, seed, length, histogram, &max);
+
+        printf("%-5s %8.1f %8.1f %6.2f %5d", names[c],
+            (double) n * rounds / secs / 1e6,
+            (double) bytes * rounds / secs / (1 << 20),
+            (double) total / n, max);
+
+        for (i = 0; i <= BUCKETS; i ++)
+            printf(" %5.1f%%", 100.0 * histogram[i] / n);
+
+        printf("\n");
+    }
+
+    free(lens);
+    free(words);
+    destroySet(sp);
+    exit(EXIT_SUCCESS);
+}
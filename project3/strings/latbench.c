@@ -0,0 +1,251 @@
+/*
+ * File:        latbench.c
+ *
+ * Description: This file contains a benchmark of how long single
+ *              operations on a set take, for comparing the tail latency
+ *              of the set implementations (build it with make SET=...).
+ *
+ *              The program collects the distinct words of the files given
+ *              as command line arguments.  Then, in each round, it adds
+ *              them all to an empty set, finds each of them, finds a word
+ *              that is not in the set for each of them, and removes them
+ *              all, each time in a random order.  Every operation is timed
+ *              on its own, and the median, the 99th, 99.9th and 99.99th
+ *              percentiles, and the slowest time for each kind are printed.
+ *              There are enough rounds for at least a million operations
+ *              of each kind, or -r gives the number.
+ */
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include <unistd.h>
+# include <time.h>
+# include "set.h"
+# include "words.h"
+
+
+/* The number of operations of each kind to time, and the percentiles
+   to report (in hundredths of a percent). */
+
+# define OPERATIONS 1000000
+
+static int percentiles[] = {5000, 9900, 9990, 9999};
+
+# define PERCENTILES (sizeof(percentiles) / sizeof(percentiles[0]))
+
+
+/*
+ * Function:    now
+ *
+ * Description: Return the time in nanoseconds.
+ */
+
+static long now(void)
+{
+    struct timespec ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+
+/*
+ * Function:    compare
+ *
+ * Description: Compare two times as for qsort().
+ */
+
+static int compare(const void *p1, const void *p2)
+{
+    long t1 = *(long *) p1, t2 = *(long *) p2;
+
+    return t1 < t2 ? -1 : t1 > t2;
+}
+
+
+/*
+ * Function:    shuffle
+ *
+ * Description: Put the N words in WORDS in a random order.
+ */
+
+static void shuffle(char **words, int n)
+{
+    int i, j;
+    char *tmp;
+
+
+    for (i = n - 1; i > 0; i --) {
+        j = rand() % (i + 1);
+        tmp = words[i];
+        words[i] = words[j];
+        words[j] = tmp;
+    }
+}
+
+
+/*
+ * Function:    report
+ *
+ * Description: Sort the N times in TIMES and print their percentiles
+ *              under the heading NAME.
+ */
+
+static void report(char *name, long *times, long n)
+{
+    int i;
+
+
+    qsort(times, n, sizeof(long), compare);
+    printf("%-7s", name);
+
+    for (i = 0; i < PERCENTILES; i ++)
+        printf(" %8ld", times[(n - 1) * percentiles[i] / 10000]);
+
+    printf(" %10ld\n", times[n - 1]);
+}
+
+
+/*
+ * Function:    main
+ *
+ * Description: Driver function for the benchmark.
+ */
+
+int main(int argc, char *argv[])
+{
+    char buffer[BUFSIZ], **words, **misses, *elt;
+    int i, n, c, round, rounds;
+    long *times[4], t, k;
+    CURSOR cursor;
+    WORDS *wp;
+    SET *sp;
+
+
+    /* Check usage and collect the distinct words. */
+
+    rounds = 0;
+
+    while ((c = getopt(argc, argv, "r:")) != -1)
+        if (c == 'r')
+            rounds = atoi(optarg);
+        else
+            optind = argc + 1;
+
+    if (optind >= argc || rounds < 0) {
+        fprintf(stderr, "usage: %s [-r rounds] file ...\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    sp = createSet(0);
+
+    for (i = optind; i < argc; i ++) {
+        if ((wp = openWords(argv[i])) == NULL) {
+            fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[i]);
+            exit(EXIT_FAILURE);
+        }
+
+        while (readWord(wp, buffer, BUFSIZ) == 1)
+            addElement(sp, buffer);
+
+        closeWords(wp);
+    }
+
+    if ((n = numElements(sp)) == 0) {
+        fprintf(stderr, "%s: no words\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+
+    /* A word with a space in it is never in the set. */
+
+    words = malloc(sizeof(char *) * n);
+    misses = malloc(sizeof(char *) * n);
+    beginElements(sp, &cursor);
+
+    for (i = 0; (elt = nextElement(&cursor)) != NULL; i ++) {
+        words[i] = strdup(elt);
+        misses[i] = malloc(strlen(elt) + 2);
+        sprintf(misses[i], "%s ", elt);
+    }
+
+    destroySet(sp);
+
+    if (rounds == 0)
+        rounds = (OPERATIONS + n - 1) / n;
+
+    for (c = 0; c < 4; c ++)
+        times[c] = malloc(sizeof(long) * n * rounds);
+
+
+    /* Time every operation of every round. */
+
+    srand(1);
+    k = 0;
+
+    for (round = 0; round < rounds; round ++, k += n) {
+        sp = createSet(0);
+        shuffle(words, n);
+
+        for (i = 0; i < n; i ++) {
+            t = now();
+            addElement(sp, words[i]);
+            times[0][k + i] = now() - t;
+        }
+
+        shuffle(words, n);
+
+        for (i = 0; i < n; i ++) {
+            t = now();
+            findElement(sp, words[i]);
+            times[1][k + i] = now() - t;
+        }
+
+        shuffle(misses, n);
+
+        for (i = 0; i < n; i ++) {
+            t = now();
+            findElement(sp, misses[i]);
+            times[2][k + i] = now() - t;
+        }
+
+        shuffle(words, n);
+
+        for (i = 0; i < n; i ++) {
+            t = now();
+            removeElement(sp, words[i]);
+            times[3][k + i] = now() - t;
+        }
+
+        destroySet(sp);
+    }
+
+
+    /* Report the percentiles in nanoseconds. */
+
+    printf("%d words, %d rounds, times in ns\n", n, rounds);
+    printf("%-7s", "op");
+
+    for (i = 0; i < PERCENTILES; i ++)
+        printf(" %7.2f%%", percentiles[i] / 100.0);
+
+    printf(" %10s\n", "max");
+    report("add", times[0], k);
+    report("find", times[1], k);
+    report("miss", times[2], k);
+    report("remove", times[3], k);
+
+    for (i = 0; i < n; i ++) {
+        free(words[i]);
+        free(misses[i]);
+    }
+
+    for (c = 0; c < 4; c ++)
+        free(times[c]);
+
+    free(misses);
+    free(words);
+    exit(EXIT_SUCCESS);
+}
@@ -10,18 +10,71 @@
  *              A set is used to maintain a collection of words that occur
  *              an odd number of times.  The counts of total words and
  *              words appearing an odd number of times are printed.
+ *
+ *              With -j, the words are sorted by hash into that many sets,
+ *              one per thread, which are then counted together.  With -b,
+ *              the words are toggled BATCH at a time with toggleElements.
  */
 
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
+# include <stdbool.h>
 # include "set.h"
+# include "words.h"
+# include "shard.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
 
 # define MAX_SIZE 18000
 
+# define BATCH 32
+
+
+/*
+ * Function:    toggle
+ *
+ * Description: Remove WORD from SP if it is there and add it otherwise.
+ */
+
+static void toggle(SET *sp, char *word)
+{
+    toggleElement(sp, word);
+}
+
+
+/*
+ * Function:    batch
+ *
+ * Description: Toggle the rest of the words of WP in SP, BATCH at a time
+ *		with toggleElements, and return the number of words read.
+ *		Each batch is hashed and its slots prefetched together before
+ *		any word is toggled, so their cache misses overlap, and each
+ *		word then takes a single search.
+ */
+
+static int batch(WORDS *wp, SET *sp)
+{
+    static char buffers[BATCH][BUFSIZ];
+    char *words[BATCH];
+    int i, n, total = 0;
+
+
+    for (i = 0; i < BATCH; i ++)
+        words[i] = buffers[i];
+
+    do {
+        for (n = 0; n < BATCH && readWord(wp, words[n], BUFSIZ) == 1; n ++)
+            ;
+
+        toggleElements(sp, words, n, NULL);
+        total += n;
+    } while (n == BATCH);
+
+    return total;
+}
+
 
 /*
  * Function:    main
@@ -31,20 +84,37 @@
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
+    WORDS *wp;
     char buffer[BUFSIZ];
-    SET *odd;
-    int words;
+    SET *odd[MAX_SHARDS];
+    int i, j, words, count, threads = 1;
+    bool bflag = false;
 
 
     /* Check usage and open the file. */
 
-    if (argc != 2) {
-        fprintf(stderr, "usage: %s file1\n", argv[0]);
+    while (argc > 1 && (strcmp(argv[1], "-b") == 0 || strcmp(argv[1], "-j") == 0)) {
+        if (strcmp(argv[1], "-b") == 0) {
+            bflag = true;
+            j = 1;
+        } else if (argc > 2) {
+            threads = atoi(argv[2]);
+            j = 2;
+        } else
+            break;
+
+        argc -= j;
+
+        for (i = 1; i < argc; i ++)
+            argv[i] = argv[i + j];
+    }
+
+    if (argc != 2 || threads < 1 || threads > MAX_SHARDS || (bflag && threads > 1)) {
+        fprintf(stderr, "usage: %s [-b | -j threads] file1\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
@@ -53,21 +123,29 @@ int main(int argc, char *argv[])
     /* Insert or delete words to compute their parity. */
 
     words = 0;
-    odd = createSet(MAX_SIZE);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
-        words ++;
+    for (i = 0; i < threads; i ++)
+        odd[i] = createSet(MAX_SIZE / threads);
 
-        if (findElement(odd, buffer))
-            removeElement(odd, buffer);
-        else
-            addElement(odd, buffer);
+    if (threads > 1)
+        words = shardWords(wp, odd, threads, toggle);
+    else if (bflag)
+        words = batch(wp, odd[0]);
+
+    while (readWord(wp, buffer, BUFSIZ) == 1) {
+        words ++;
+        toggleElement(odd[0], buffer);
     }
 
+    for (i = count = 0; i < threads; i ++)
+        count += numElements(odd[i]);
+
     printf("%d total words\n", words);
-    printf("%d words occur an odd number of times\n", numElements(odd));
-    fclose(fp);
+    printf("%d words occur an odd number of times\n", count);
+    closeWords(wp);
+
+    for (i = 0; i < threads; i ++)
+        destroySet(odd[i]);
 
-    destroySet(odd);
     exit(EXIT_SUCCESS);
 }
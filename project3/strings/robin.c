@@ -0,0 +1,698 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "robin.h"
+#include "snapshot.h"
+#define EMPTY 0
+#define FILLED 1
+#define MAX_LOAD 80
+#define MIN_LOAD 20
+#define MIN_LENGTH 16
+#define BATCH 16
+#define MAGIC "robin1"
+#define ORDER 0x01020304
+#define ALIGN(n) (((n) + sizeof(char*) - 1) & ~(sizeof(char*) - 1))
+
+/*
+ * This file implements the same set as table.c with Robin Hood hashing instead of plain linear
+ * probing. An element being inserted takes the slot of any element that is closer to its home slot
+ * than the new one is to its own, so every element ends up about as far from home as every other,
+ * and a search can stop as soon as it meets an element closer to home than it has come. Removing an
+ * element shifts the ones after it back a slot instead of leaving a DELETED flag, so there are no
+ * tombstones and the probe sequences stay short however many removes there are. The short probes
+ * let the table fill up to MAX_LOAD percent before it doubles (details are commented above each
+ * function). A snapshot file (see saveSet) is a header, the hashes, the slots, the flags, and the
+ * strings, with each slot holding the offset of its string. The set keeps a base that is added to
+ * every slot, 0 normally, so a loaded snapshot is searched right where it is mapped.
+ */
+struct set
+{
+	int count;	/*number of elements*/
+	int length; /*length of array */
+	char **data; /*array of strings */
+	unsigned *hashes; /*hash of each element, so we can find its home slot again */
+	char *flags; /*array of flags */
+	HASHFUNC hash; /*the hash function for the strings */
+	unsigned long seed; /*and the seed it is given */
+	uintptr_t base; /*added to each slot: 0, or where the strings of a snapshot are */
+	bool frozen; /*whether the arrays are still in the snapshot, which cannot be changed */
+	void *mapping; /*the snapshot file, if the set was loaded from one */
+	size_t mapsize; /*and its size */
+};
+typedef struct set SET;
+
+struct header
+{
+	char magic[8]; /*MAGIC, to tell a snapshot from any other file */
+	int order; /*ORDER, as the machine that saved it stores it */
+	int count; /*number of elements */
+	int length; /*length of array */
+	char hash[8]; /*name of the hash function (see hashName) */
+	unsigned long seed; /*and its seed */
+	size_t strings; /*bytes of the strings */
+};
+
+/*
+ * Function: hashOf
+ * -------------------------------
+ * Summary: Hashes a string with the hash function and seed of the set.
+ * Runtime: O(length of the string)
+ */
+static inline unsigned hashOf(SET *sp, char *s) {
+	return (*sp->hash)(s, strlen(s), sp->seed);
+}
+
+/*
+ * Function: *keyAt
+ * -------------------------------
+ * Summary: Returns the string in slot locn.
+ * Runtime: O(1)
+ */
+static inline char *keyAt(SET *sp, int locn) {
+	return (char *) (sp->base + (uintptr_t) sp->data[locn]);
+}
+
+/*
+ * Function: distance
+ * -------------------------------
+ * Summary: Returns how far the element in slot locn is from its home slot.
+ * Runtime: O(1)
+ */
+static inline int distance(SET *sp, int locn) {
+	int head = sp->hashes[locn]%sp->length;
+	return locn >= head ? locn - head : locn + sp->length - head;
+}
+
+/*
+ * Function: allocate
+ * -------------------------------
+ * Summary: Gives the set empty arrays of the given length.
+ * Runtime: O(n)
+ */
+static void allocate(SET *sp, int length) {
+	sp->length = length;
+	sp->data = malloc(sizeof(char*)*length);
+	sp->hashes = malloc(sizeof(unsigned)*length);
+	sp->flags = calloc(length, sizeof(char));		// every flag starts out EMPTY
+	assert(sp->data!=NULL && sp->hashes!=NULL && sp->flags!=NULL);
+}
+
+/*
+ * Function: *createHashedSet
+ * -------------------------------
+ * Summary: Allocates the set with room for maxElts elements under MAX_LOAD, hashing with the given
+ * hash function and seed. As in table.c, maxElts is only a hint and the table grows when it needs to.
+ * Runtime: O(n)
+ */
+SET *createHashedSet(int maxElts, HASHFUNC hash, unsigned long seed){
+	SET *sp;
+
+	sp=malloc(sizeof(SET));
+	assert(sp!=NULL);
+
+	sp->count = 0;
+	sp->hash = hash;
+	sp->seed = seed;
+	sp->base = 0;
+	sp->frozen = false;
+	sp->mapping = NULL;
+	sp->mapsize = 0;
+	allocate(sp, maxElts*100/MAX_LOAD+1 < MIN_LENGTH ? MIN_LENGTH : maxElts*100/MAX_LOAD+1);
+	return sp;
+}
+
+/*
+ * Function: *createSet
+ * -------------------------------
+ * Summary: Creates a set that hashes with wyHash and a seed of zero, like table.c.
+ * Runtime: O(n)
+ */
+SET *createSet(int maxElts){
+	return createHashedSet(maxElts, wyHash, 0);
+}
+
+/*
+ * Function: destroySet
+ * --------------------------------
+ * Summary: Frees every element, the arrays, and then the set. If the set was loaded from a snapshot, the
+ * file is unmapped.
+ * Runtime: O(n)
+ */
+void destroySet(SET *sp){
+	int i;
+
+	if (!sp->frozen) {
+		for (i=0;i<sp->length;i++){
+			if (sp->flags[i]==FILLED){
+				free(sp->data[i]);
+			}
+		}
+		free(sp->flags);
+		free(sp->hashes);
+		free(sp->data);
+	}
+	if (sp->mapping != NULL) {
+		munmap(sp->mapping, sp->mapsize);
+	}
+	free(sp);
+}
+
+/*
+ * Function: numElements
+ * ----------------------------------
+ * Summary: Simply returns the number of elements in the set
+ * Runtime: O(1)
+ */
+int numElements(SET *sp){
+	assert(sp!=NULL);
+	return sp->count;
+}
+
+/*
+ * Function: search
+ * ------------------------------------
+ * Summary: Walks forward from the home slot of elt. Because of the way elements are placed, once we
+ * reach an EMPTY slot or an element that is closer to its home than we are to ours, elt cannot be
+ * further on. The stored hashes are compared first so strcmp is only called on a likely match.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static int search(SET *sp, char *elt, unsigned hash, bool *found) {
+	int locn = hash%sp->length;
+	int dist;
+
+	for (dist = 0; sp->flags[locn] == FILLED && distance(sp, locn) >= dist; dist++) {
+		if (sp->hashes[locn] == hash && strcmp(keyAt(sp, locn), elt) == 0) {
+			*found = true;
+			return locn;
+		}
+		locn = (locn + 1)%sp->length;
+	}
+	*found = false;
+	return locn;
+}
+
+/*
+ * Function: displace
+ * ------------------------------------
+ * Summary: Puts an element that is not in the set into it, starting at locn, which is dist slots past
+ * its home. Whenever we pass an element that is closer to its home than the one we are carrying, we
+ * swap them and carry on with the one we displaced, until we reach an EMPTY slot.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void displace(SET *sp, int locn, int dist, char *elt, unsigned hash) {
+	int other;
+	char *tmp;
+	unsigned tmphash;
+
+	while (sp->flags[locn] == FILLED) {
+		other = distance(sp, locn);
+		if (other < dist) {							// the resident is better off than us, so it moves on instead
+			tmp = sp->data[locn];
+			tmphash = sp->hashes[locn];
+			sp->data[locn] = elt;
+			sp->hashes[locn] = hash;
+			elt = tmp;
+			hash = tmphash;
+			dist = other;
+		}
+		locn = (locn + 1)%sp->length;
+		dist++;
+	}
+	sp->data[locn] = elt;
+	sp->hashes[locn] = hash;
+	sp->flags[locn] = FILLED;
+}
+
+/*
+ * Function: place
+ * ------------------------------------
+ * Summary: Puts an element that is not in the set into it, starting at its home slot.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void place(SET *sp, char *elt, unsigned hash) {
+	displace(sp, hash%sp->length, 0, elt, hash);
+}
+
+/*
+ * Function: rehash
+ * ------------------------------------
+ * Summary: Moves every element into new arrays of the given length. The hashes are kept so the
+ * strings are not read again.
+ * Runtime: O(n)
+ */
+static void rehash(SET *sp, int length) {
+	char **data = sp->data, *flags = sp->flags;
+	unsigned *hashes = sp->hashes;
+	int i, oldlength = sp->length;
+
+	allocate(sp, length);
+	for (i = 0; i < oldlength; i++) {
+		if (flags[i] == FILLED) {
+			place(sp, data[i], hashes[i]);
+		}
+	}
+	free(data);
+	free(hashes);
+	free(flags);
+}
+
+/*
+ * Function: thaw
+ * ------------------------------------
+ * Summary: Called before the first change to a set loaded from a snapshot. The arrays are copied out of the
+ * file and every string is copied too, since the set frees its strings when they are removed.
+ * Runtime: O(n)
+ */
+static void thaw(SET *sp) {
+	char **data = sp->data, *flags = sp->flags;
+	unsigned *hashes = sp->hashes;
+	int i;
+
+	allocate(sp, sp->length);
+	memcpy(sp->hashes, hashes, sizeof(unsigned)*sp->length);
+	memcpy(sp->flags, flags, sp->length);
+	for (i = 0; i < sp->length; i++) {
+		if (flags[i] == FILLED) {
+			sp->data[i] = strdup((char *) (sp->base + (uintptr_t) data[i]));
+			assert(sp->data[i]!=NULL);
+		}
+	}
+	sp->base = 0;
+	sp->frozen = false;
+}
+
+/*
+ * Function: insert
+ * -------------------------------------
+ * Summary: Puts a copy of elt, which a search for it stopped at locn without finding, into the set. Every slot
+ * the search passed holds an element at least as far from home as elt would be, so placing can carry on from
+ * where the search stopped. If the set would go over MAX_LOAD it is doubled first, and elt is placed from its
+ * home in the new table instead.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void insert(SET *sp, int locn, char *elt, unsigned hash){
+	if ((long) (sp->count+1)*100 > (long) sp->length*MAX_LOAD) {
+		rehash(sp, sp->length*2);
+		place(sp, strdup(elt), hash);
+	}
+	else {
+		displace(sp, locn, (locn + sp->length - hash%sp->length)%sp->length, strdup(elt), hash);
+	}
+	sp->count++;
+}
+
+/*
+ * Function: removeAt
+ * ------------------------------------
+ * Summary: Frees the element at locn and shifts the elements after it back one slot until we reach an EMPTY
+ * slot or an element already in its home slot. That leaves the table exactly as if the element had never been
+ * added, with no DELETED flag. If the set falls under MIN_LOAD it is halved.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static void removeAt(SET *sp, int locn){
+	int next;
+
+	free(sp->data[locn]);
+	next = (locn + 1)%sp->length;
+	while (sp->flags[next] == FILLED && distance(sp, next) > 0) {
+		sp->data[locn] = sp->data[next];
+		sp->hashes[locn] = sp->hashes[next];
+		locn = next;
+		next = (next + 1)%sp->length;
+	}
+	sp->flags[locn] = EMPTY;
+	sp->count--;
+	if ((long) sp->count*100 < (long) sp->length*MIN_LOAD && sp->length/2 >= MIN_LENGTH) {
+		rehash(sp, sp->length/2);
+	}
+}
+
+/*
+ * Function: addElement
+ * -------------------------------------
+ * Summary: If elt is not in the set, a copy is inserted from where the search for it stopped.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void addElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool found;
+	unsigned hash = hashOf(sp, elt);
+	int locn;
+
+	if (sp->frozen) {
+		thaw(sp);
+	}
+	locn = search(sp, elt, hash, &found);
+	if (!found) {
+		insert(sp, locn, elt, hash);
+	}
+}
+
+/*
+ * Function: removeElement
+ * ------------------------------------
+ * Summary: If elt is found, it is removed with removeAt.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+void removeElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool found;
+	int locn;
+
+	if (sp->frozen) {
+		thaw(sp);
+	}
+	locn = search(sp, elt, hashOf(sp, elt), &found);
+	if (found) {
+		removeAt(sp, locn);
+	}
+}
+
+/*
+ * Function: toggle
+ * ------------------------------------
+ * Summary: Removes elt if it is in the set and inserts it if not, both from where the one search for it
+ * stopped, given its hash. Returns whether it was added.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static bool toggle(SET *sp, char *elt, unsigned hash){
+	bool found;
+	int locn;
+
+	if (sp->frozen) {
+		thaw(sp);
+	}
+	locn = search(sp, elt, hash, &found);
+	if (found) {
+		removeAt(sp, locn);
+	}
+	else {
+		insert(sp, locn, elt, hash);
+	}
+	return !found;
+}
+
+/*
+ * Function: toggleElement
+ * ------------------------------------
+ * Summary: Hashes elt and toggles it (see toggle). Returns whether it was added.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+bool toggleElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	return toggle(sp, elt, hashOf(sp, elt));
+}
+
+/*
+ * Function: *findElement
+ * -------------------------------------
+ * Summary: Returns the matching element, or NULL if there is none.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+char *findElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	bool found;
+	int locn = search(sp, elt, hashOf(sp, elt), &found);
+	return found ? keyAt(sp, locn) : NULL;
+}
+
+/*
+ * Function: findElements
+ * -------------------------------------
+ * Summary: Looks up n elements at once and stores the match for each (or NULL) in results. As in table.c, they are
+ * taken BATCH at a time, and every element of a batch is hashed and its home slot prefetched before any is searched
+ * for, so their cache misses overlap.
+ * Runtime Expected/Worst: O(n)/O(n * length of array)
+ */
+void findElements(SET *sp, char **elts, int n, char **results){
+	assert(sp!=NULL && (n==0 || (elts!=NULL && results!=NULL)));
+	unsigned hashes[BATCH];
+	bool found;
+	int i, j, m, locn;
+
+	for (i = 0; i < n; i += BATCH) {
+		m = n - i < BATCH ? n - i : BATCH;
+		for (j = 0; j < m; j++) {
+			hashes[j] = hashOf(sp, elts[i+j]);
+			locn = hashes[j]%sp->length;
+			__builtin_prefetch(&sp->flags[locn]);
+			__builtin_prefetch(&sp->hashes[locn]);
+			__builtin_prefetch(&sp->data[locn]);
+		}
+		for (j = 0; j < m; j++) {
+			locn = search(sp, elts[i+j], hashes[j], &found);
+			results[i+j] = found ? keyAt(sp, locn) : NULL;
+		}
+	}
+}
+
+/*
+ * Function: toggleElements
+ * -------------------------------------
+ * Summary: Toggles n elements in order and stores whether each was added in added (if it is not NULL). As in
+ * findElements, every element of a BATCH is hashed and its home prefetched before any is toggled, and then each
+ * takes a single search.
+ * Runtime Expected/Worst: O(n)/O(n * length of array)
+ */
+void toggleElements(SET *sp, char **elts, int n, bool *added){
+	assert(sp!=NULL && (n==0 || elts!=NULL));
+	unsigned hashes[BATCH];
+	int i, j, m, locn;
+	bool result;
+
+	for (i = 0; i < n; i += BATCH) {
+		m = n - i < BATCH ? n - i : BATCH;
+		for (j = 0; j < m; j++) {
+			hashes[j] = hashOf(sp, elts[i+j]);
+			locn = hashes[j]%sp->length;
+			__builtin_prefetch(&sp->flags[locn]);
+			__builtin_prefetch(&sp->hashes[locn]);
+			__builtin_prefetch(&sp->data[locn]);
+		}
+		for (j = 0; j < m; j++) {
+			result = toggle(sp, elts[i+j], hashes[j]);
+			if (added != NULL) {
+				added[i+j] = result;
+			}
+		}
+	}
+}
+
+/*
+ * Function: **getElements
+ * ----------------------------------
+ * Summary: getElements returns a copy of the array for the user to play with
+ * Runtime: O(n)
+ */
+char **getElements(SET *sp){
+	assert(sp!=NULL);
+	char **arr;
+	int i, lastIndex = 0;
+
+	arr = malloc(sizeof(char*)*sp->count);
+	for (i = 0; i < sp->length; i++){
+		if (sp->flags[i] == FILLED){
+			arr[lastIndex++] = strdup(keyAt(sp, i));
+		}
+	}
+	return arr;
+}
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor before the first element. The set must not change while it is being
+ * walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->index = 0;
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the element in the next FILLED slot, or NULL when there are none left.
+ * Runtime: O(1) amortized
+ */
+char *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	SET *sp = cp->set;
+
+	while (cp->index < sp->length){
+		if (sp->flags[cp->index++] == FILLED){
+			return keyAt(sp, cp->index-1);
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Function: averageProbe
+ * ----------------------------------
+ * Summary: Returns the average number of slots a successful search looks at, which is one more than
+ * the average distance of the elements from their home slots.
+ * Runtime: O(n)
+ */
+double averageProbe(SET *sp){
+	assert(sp!=NULL);
+	long total = 0;
+	int i;
+
+	if (sp->count == 0)
+		return 0;
+	for (i = 0; i < sp->length; i++){
+		if (sp->flags[i] == FILLED){
+			total += distance(sp, i) + 1;
+		}
+	}
+	return (double) total / sp->count;
+}
+
+/*
+ * Function: maxProbe
+ * ----------------------------------
+ * Summary: Returns the most slots any successful search looks at, the longest distance from home
+ * plus one.
+ * Runtime: O(n)
+ */
+int maxProbe(SET *sp){
+	assert(sp!=NULL);
+	int i, max = 0;
+
+	for (i = 0; i < sp->length; i++){
+		if (sp->flags[i] == FILLED && distance(sp, i) + 1 > max){
+			max = distance(sp, i) + 1;
+		}
+	}
+	return max;
+}
+
+/*
+ * Function: saveSet
+ * ----------------------------------
+ * Summary: Writes the set to a snapshot file that loadSet can map back in: a header, the hashes, the slots with
+ * the offset of each string in place of its pointer, the flags, and then the strings packed one after another in
+ * slot order. The file is written under a temporary name and then renamed, so a set loaded from the old file
+ * (even this one) keeps working and nobody can load half a snapshot. Returns 0 if the file cannot be written or
+ * the hash function has no name (see hashName), and 1 otherwise.
+ * Runtime: O(n)
+ */
+int saveSet(SET *sp, char *path){
+	assert(sp!=NULL && path!=NULL);
+	static char padding[sizeof(char*)];
+	struct header header;
+	size_t offset = 0;
+	char *name, *slot;
+	char temp[strlen(path) + 5];
+	FILE *fp;
+	int i, failed;
+
+	if ((name = hashName(sp->hash)) == NULL || (fp = fopen(strcat(strcpy(temp, path), ".tmp"), "wb")) == NULL){
+		return 0;
+	}
+	memset(&header, 0, sizeof(header));
+	strcpy(header.magic, MAGIC);
+	header.order = ORDER;
+	header.count = sp->count;
+	header.length = sp->length;
+	strcpy(header.hash, name);
+	header.seed = sp->seed;
+	for (i=0;i<sp->length;i++){
+		if (sp->flags[i]==FILLED){
+			header.strings += strlen(keyAt(sp, i)) + 1;
+		}
+	}
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(padding, ALIGN(sizeof(header)) - sizeof(header), 1, fp);
+	fwrite(sp->hashes, sizeof(unsigned), sp->length, fp);
+	fwrite(padding, ALIGN(sizeof(unsigned)*sp->length) - sizeof(unsigned)*sp->length, 1, fp);
+
+	for (i=0;i<sp->length;i++){
+		slot = NULL;
+		if (sp->flags[i]==FILLED){
+			slot = (char *) offset;
+			offset += strlen(keyAt(sp, i)) + 1;
+		}
+		fwrite(&slot, sizeof(char*), 1, fp);
+	}
+	fwrite(sp->flags, sp->length, 1, fp);
+
+	for (i=0;i<sp->length;i++){
+		if (sp->flags[i]==FILLED){
+			fwrite(keyAt(sp, i), strlen(keyAt(sp, i)) + 1, 1, fp);
+		}
+	}
+	failed = ferror(fp);
+	if (fclose(fp) != 0 || failed || rename(temp, path) != 0){
+		remove(temp);
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Function: *loadSet
+ * ----------------------------------
+ * Summary: Maps a snapshot file written by saveSet into memory and returns a set whose arrays are the ones in the
+ * file, so nothing is read until it is searched. Returns NULL if the file cannot be opened or is not a snapshot
+ * from this implementation on this kind of machine. The contents of the arrays are trusted.
+ * Runtime: O(1)
+ */
+SET *loadSet(char *path){
+	assert(path!=NULL);
+	struct header *hp;
+	struct stat st;
+	char *mapping;
+	size_t hashes, data, flags, strings;
+	SET *sp;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) < 0){
+		return NULL;
+	}
+	mapping = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= sizeof(struct header)){
+		mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if (mapping == MAP_FAILED){
+		return NULL;
+	}
+
+	hp = (struct header *) mapping;
+	hashes = ALIGN(sizeof(struct header));
+	data = hashes + ALIGN(sizeof(unsigned)*(size_t) hp->length);
+	flags = data + sizeof(char*)*(size_t) hp->length;
+	strings = flags + hp->length;
+	if (memcmp(hp->magic, MAGIC, sizeof(MAGIC)) != 0 || hp->order != ORDER || hp->length < MIN_LENGTH ||
+			hp->hash[sizeof(hp->hash)-1] != '\0' || findHash(hp->hash) == NULL || strings + hp->strings != st.st_size){
+		munmap(mapping, st.st_size);
+		return NULL;
+	}
+	madvise(mapping, st.st_size, MADV_RANDOM);		// searches jump all over the table
+
+	sp = malloc(sizeof(SET));
+	assert(sp!=NULL);
+	sp->count = hp->count;
+	sp->length = hp->length;
+	sp->hashes = (unsigned *) (mapping + hashes);
+	sp->data = (char **) (mapping + data);
+	sp->flags = mapping + flags;
+	sp->hash = findHash(hp->hash);
+	sp->seed = hp->seed;
+	sp->base = (uintptr_t) (mapping + strings);
+	sp->frozen = true;
+	sp->mapping = mapping;
+	sp->mapsize = st.st_size;
+	return sp;
+}
@@ -11,10 +11,20 @@
 # ifndef SET_H
 # define SET_H
 
+# include <stdbool.h>
+# include "hash.h"
+
 typedef struct set SET;
 
+typedef struct cursor {
+    SET *set;
+    int index;
+} CURSOR;
+
 SET *createSet(int maxElts);
 
+SET *createHashedSet(int maxElts, HASHFUNC hash, unsigned long seed);
+
 void destroySet(SET *sp);
 
 int numElements(SET *sp);
@@ -23,8 +33,18 @@ void addElement(SET *sp, char *elt);
 
 void removeElement(SET *sp, char *elt);
 
+bool toggleElement(SET *sp, char *elt);
+
 char *findElement(SET *sp, char *elt);
 
+void findElements(SET *sp, char **elts, int n, char **results);
+
+void toggleElements(SET *sp, char **elts, int n, bool *added);
+
 char **getElements(SET *sp);
 
+void beginElements(SET *sp, CURSOR *cp);
+
+char *nextElement(CURSOR *cp);
+
 # endif /* SET_H */
@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "shard.h"
+#define ROUND_SIZE (4 << 20)
+#define MAX_WORD (BUFSIZ - 1)
+#define SHARD_SEED 0x5bd1e995
+
+/*
+ * This file runs the words of a file through n sets with n threads and no locks. The text is split
+ * into n parts (see splitWords) and the work goes in rounds. First each thread reads the next
+ * ROUND_SIZE bytes or so of its part and sorts the words into n buckets by their hash, one bucket
+ * for each set. Then each thread takes the buckets for its own set from every thread and applies the
+ * function to each word. Since a word always hashes to the same set, each set sees every copy of the
+ * words it is responsible for, and no two threads ever touch the same set. A round only keeps views
+ * of the words in the buckets, so the memory used stays the same however big the file is
+ * (details are commented above each function).
+ */
+struct view
+{
+	char *word; /*the word, in the text */
+	size_t len; /*and its length */
+};
+
+struct bucket
+{
+	struct view *views; /*the words for one set from one thread */
+	int count; /*number of words */
+	int size; /*number of words there is room for */
+};
+
+struct pipeline
+{
+	int n; /*number of threads and sets */
+	int parts; /*number of parts the text was split into */
+	WORDS *words[MAX_SHARDS]; /*the part each thread reads */
+	SET **sets; /*the set each thread updates */
+	void (*apply)(SET *, char *); /*what to do to a set with a word */
+	struct bucket buckets[MAX_SHARDS][MAX_SHARDS]; /*buckets[i][j] holds words from thread i for set j */
+	bool more[MAX_SHARDS]; /*whether each thread's part has words left after this round */
+	long count[MAX_SHARDS]; /*number of words each thread has read */
+	pthread_barrier_t barrier; /*where the threads wait for each other between steps */
+};
+
+struct worker
+{
+	struct pipeline *pp; /*the work */
+	int id; /*which thread, and so which part and which set */
+};
+
+/*
+ * Function: push
+ * -------------------------------
+ * Summary: Adds a word to a bucket, doubling its array when it is full.
+ * Runtime: O(1) amortized
+ */
+static void push(struct bucket *bp, char *word, size_t len) {
+	if (bp->count == bp->size) {
+		bp->size = bp->size == 0 ? 1024 : bp->size * 2;
+		bp->views = realloc(bp->views, sizeof(struct view) * bp->size);
+		assert(bp->views!=NULL);
+	}
+	bp->views[bp->count].word = word;
+	bp->views[bp->count].len = len;
+	bp->count++;
+}
+
+/*
+ * Function: *work
+ * -------------------------------
+ * Summary: What each thread does: rounds of sorting the words of its part into buckets, waiting for the
+ * others, applying the words in its set's buckets, and waiting again, until no part has words left.
+ * Words longer than MAX_WORD are cut short, the same as readWord with a buffer of BUFSIZ does.
+ * Runtime: O(n) per thread, with n the number of words in its part and its set
+ */
+static void *work(void *arg) {
+	struct worker *wp = arg;
+	struct pipeline *pp = wp->pp;
+	char buffer[BUFSIZ], *word = NULL;
+	size_t len, bytes;
+	struct bucket *bp;
+	bool more;
+	int i, j;
+
+	do {
+		if (wp->id < pp->parts) {						// sort the next round of words by set
+			for (bytes = 0; bytes < ROUND_SIZE && (word = nextWord(pp->words[wp->id], &len)) != NULL; bytes += len + 1) {
+				len = len < MAX_WORD ? len : MAX_WORD;
+				push(&pp->buckets[wp->id][wyHash(word, len, SHARD_SEED) % pp->n], word, len);
+				pp->count[wp->id]++;
+			}
+			pp->more[wp->id] = word != NULL;
+		}
+		pthread_barrier_wait(&pp->barrier);
+
+		more = false;									// apply the words for our set
+		for (i = 0; i < pp->n; i++) {
+			more |= pp->more[i];
+			bp = &pp->buckets[i][wp->id];
+			for (j = 0; j < bp->count; j++) {
+				memcpy(buffer, bp->views[j].word, bp->views[j].len);
+				buffer[bp->views[j].len] = '\0';
+				(*pp->apply)(pp->sets[wp->id], buffer);
+			}
+			bp->count = 0;
+		}
+		pthread_barrier_wait(&pp->barrier);
+	} while (more);
+	return NULL;
+}
+
+/*
+ * Function: shardWords
+ * -------------------------------
+ * Summary: Reads the rest of the words of wp with n threads (at most MAX_SHARDS) and calls apply on each word with
+ * the set in sets it belongs to. The same word always goes to the same set for the same n, so the sets can be
+ * filled from one file and then updated from another. Returns the number of words read.
+ * Runtime: O(n / threads)
+ */
+long shardWords(WORDS *wp, SET **sets, int n, void (*apply)(SET *sp, char *word)) {
+	assert(wp!=NULL && sets!=NULL && n>0 && n<=MAX_SHARDS);
+	struct pipeline *pp = calloc(1, sizeof(struct pipeline));
+	struct worker workers[MAX_SHARDS];
+	pthread_t threads[MAX_SHARDS];
+	long count = 0;
+	int i, j;
+
+	assert(pp!=NULL);
+	pp->n = n;
+	pp->sets = sets;
+	pp->apply = apply;
+	pp->parts = splitWords(wp, pp->words, n);
+	pthread_barrier_init(&pp->barrier, NULL, n);
+
+	for (i = 0; i < n; i++) {
+		workers[i].pp = pp;
+		workers[i].id = i;
+		if (i > 0) {
+			pthread_create(&threads[i], NULL, work, &workers[i]);
+		}
+	}
+	work(&workers[0]);									// the calling thread works too
+	for (i = 1; i < n; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	for (i = 0; i < n; i++) {
+		count += pp->count[i];
+		if (i < pp->parts) {
+			closeWords(pp->words[i]);
+		}
+		for (j = 0; j < n; j++) {
+			free(pp->buckets[i][j].views);
+		}
+	}
+	pthread_barrier_destroy(&pp->barrier);
+	free(pp);
+	return count;
+}
@@ -0,0 +1,21 @@
+/*
+ * File:        shard.h
+ *
+ * Description: This file contains the declarations for running the
+ *              words of a file through several sets at once, one thread
+ *              per set.  Each word is sent to the set picked by its hash,
+ *              so every set holds a different part of the words and the
+ *              sets together act like one.
+ */
+
+# ifndef SHARD_H
+# define SHARD_H
+
+# include "set.h"
+# include "words.h"
+
+# define MAX_SHARDS 64
+
+long shardWords(WORDS *wp, SET **sets, int n, void (*apply)(SET *sp, char *word));
+
+# endif /* SHARD_H */
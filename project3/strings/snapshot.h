@@ -0,0 +1,23 @@
+/*
+ * File:        snapshot.h
+ *
+ * Description: This file contains the declarations for saving a hash set
+ *              to a file and loading it back.  A snapshot holds no
+ *              pointers, only offsets, so loading one just maps the file
+ *              into memory and the set can be searched straight away,
+ *              without reading or rehashing its strings.  A loaded set is
+ *              copied into memory the first time it is changed.  Snapshots
+ *              can only be loaded by the implementation, and on the kind of
+ *              machine, that saved them.
+ */
+
+# ifndef SNAPSHOT_H
+# define SNAPSHOT_H
+
+# include "set.h"
+
+int saveSet(SET *sp, char *path);
+
+SET *loadSet(char *path);
+
+# endif /* SNAPSHOT_H */
@@ -3,88 +3,488 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "snapshot.h"
 #define EMPTY 0
-#define FILLED 1
-#define DELETED 2
+#define DELETED 1
+#define FILLED 0x80
+#define GROUP 16
+#define MAX_LOAD 50
+#define MIN_LOAD 12
+#define MIN_LENGTH 16
+#define MIGRATE_STEP 16
+#define MIN_CHUNK 4096
+#define MAX_CHUNK (1 << 20)
+#define SHORT 16
+#define BATCH 16
+#define LONG ((char) -1)
+#define MAGIC "table1"
+#define ORDER 0x01020304
+#define ALIGN(n) (((n) + GROUP - 1) & ~(size_t) (GROUP - 1))
 
 /*
- * This file defines the struct called set and implements its 
- * different functions including creating and destroying the set, adding and removing elements, 
+ * This file defines the struct called set and implements its
+ * different functions including creating and destroying the set, adding and removing elements,
  * and searching (details are commented above each function).
+ * The table resizes itself to keep its load (FILLED and DELETED slots) under MAX_LOAD percent and
+ * its elements over MIN_LOAD percent. Rather than rehashing everything at once, a resize keeps the
+ * old table around and every add and remove moves the next MIGRATE_STEP of its slots over to the
+ * new one, so the cost of a resize is spread over the operations that follow it.
+ * Each flag is a control byte: a FILLED slot keeps seven bits of its element's hash under the FILLED
+ * bit, so a search can check a whole GROUP of flags against the hash at once (with SSE2 where it is
+ * available) and only calls strcmp on the slots whose bits match. Every flags array has GROUP extra
+ * bytes at the end that copy the first ones, so a group starting near the end can be read in one go.
+ * The strings themselves are copied into an arena of chunks that the set owns rather than each being
+ * strdup'd, so adding an element does not call malloc and destroying the set only frees the chunks.
+ * A removed string's bytes are not reused; once they outnumber the bytes still in use, the live strings
+ * are copied into a fresh arena (compacted) and the old one is freed.
+ * A string shorter than SHORT bytes does not go in the arena at all but in the slot itself, padded with zeros, with
+ * its last byte holding how many of the SHORT - 1 bytes are left over (which is 0, the null byte, when none are).
+ * A longer string's slot holds a pointer into the arena and LONG in that byte. So a search for a short string
+ * compares slots directly instead of following pointers, and only touches the cache line its slot is in. Compile with
+ * -DPOINTER_SLOTS to put every string in the arena and keep a plain pointer in each slot instead.
+ * A snapshot file (see saveSet) is a header, the slots, the flags, and then the long strings one after another,
+ * with each long slot holding the offset of its string instead of a pointer. The set keeps a base that is added
+ * to the pointer in every long slot: 0 normally, and the address of the strings of a loaded snapshot, so a
+ * snapshot is searched right where it is mapped.
  * @author: Jonathan Trinh
  * @version: 5022017
  */
+struct chunk
+{
+	struct chunk *next; /*the chunk allocated before this one */
+	size_t used; /*bytes of text handed out */
+	size_t size; /*bytes of text there are */
+	char text[]; /*the strings */
+};
+
+#ifdef POINTER_SLOTS
+typedef char *SLOT;
+#else
+typedef struct slot
+{
+	char text[SHORT]; /*a short string, or a pointer to a long one and LONG in the last byte */
+} SLOT;
+#endif
+
 struct set
 {
-	int count;	/*number of elements */
+	int count;	/*number of elements (in both tables) */
 	int length; /*length of array */
-	char **data; /*array of strings */
-	char* flags; /*array of flags */
+	SLOT *data; /*array of strings */
+	char* flags; /*array of flags (control bytes) */
+	int deleted; /*number of DELETED flags in the array */
+	int oldcount; /*number of elements still in the old array */
+	int oldlength; /*length of the old array, 0 when not resizing */
+	SLOT *olddata; /*array being moved into data */
+	char *oldflags; /*flags of the old array */
+	int moved; /*slots of the old array moved so far */
+	HASHFUNC hash; /*the hash function for the strings */
+	unsigned long seed; /*and the seed it is given */
+	struct chunk *chunks; /*the arena the strings are copied into, newest chunk first */
+	long live; /*bytes of the arena taken by elements */
+	long garbage; /*bytes of the arena left behind by removed elements */
+	uintptr_t base; /*added to the pointer in a long slot: 0, or where the strings of a snapshot are */
+	bool frozen; /*whether data and flags are still in the snapshot, which cannot be changed */
+	void *mapping; /*the snapshot file, if the set was loaded from one */
+	size_t mapsize; /*and its size */
 };
 typedef struct set SET;
 
-static int search(SET *sp, char *elt, bool *found);		// prototyping the search function
+struct header
+{
+	char magic[8]; /*MAGIC, to tell a snapshot from any other file */
+	int order; /*ORDER, as the machine that saved it stores it */
+	int slot; /*size of a slot */
+	int count; /*number of elements */
+	int length; /*length of array */
+	int deleted; /*number of DELETED flags in the array */
+	char hash[8]; /*name of the hash function (see hashName) */
+	unsigned long seed; /*and its seed */
+	size_t strings; /*bytes of the long strings */
+};
+
+static int search(SET *sp, char *elt, SLOT *key, unsigned hash, bool *found, bool *old);		// prototyping the search function
+static char *store(SET *sp, char *elt, size_t len);
+
+/*
+ * Function: hashOf
+ * -------------------------------
+ * Summary: Hashes a string of the given length with the hash function and seed of the set.
+ * Runtime: O(length of the string)
+ */
+static inline unsigned hashOf(SET *sp, char *s, size_t len) {
+	return (*sp->hash)(s, len, sp->seed);
+}
+
+#ifdef POINTER_SLOTS
+/*
+ * Function: *keyOf
+ * -------------------------------
+ * Summary: Returns the string in a slot.
+ * Runtime: O(1)
+ */
+static inline char *keyOf(SET *sp, SLOT *slot) {
+	return (char *) (sp->base + (uintptr_t) *slot);
+}
+
+/*
+ * Function: pointTo
+ * -------------------------------
+ * Summary: Makes a slot point to a string.
+ * Runtime: O(1)
+ */
+static inline void pointTo(SLOT *slot, char *s) {
+	*slot = s;
+}
+
+/*
+ * Function: keyLength
+ * -------------------------------
+ * Summary: Returns the length of the string in a slot.
+ * Runtime: O(length of the string)
+ */
+static inline size_t keyLength(SET *sp, SLOT *slot) {
+	return strlen(keyOf(sp, slot));
+}
+
+/*
+ * Function: isLong
+ * -------------------------------
+ * Summary: Returns whether the string in a slot is in the arena, which it always is.
+ * Runtime: O(1)
+ */
+static inline bool isLong(SLOT *slot) {
+	return true;
+}
+
+/*
+ * Function: makeKey
+ * -------------------------------
+ * Summary: There is nothing to prepare for a search, since every slot is compared with strcmp.
+ * Runtime: O(1)
+ */
+static inline void makeKey(SLOT *key, char *elt, size_t len) {
+	*key = elt;
+}
+
+/*
+ * Function: matches
+ * -------------------------------
+ * Summary: Returns whether the string in a slot is elt.
+ * Runtime: O(length of the string)
+ */
+static inline bool matches(SET *sp, SLOT *slot, char *elt, SLOT *key) {
+	return strcmp(keyOf(sp, slot), elt) == 0;
+}
 
-/**
- * Function: strhash
+/*
+ * Function: putKey
  * -------------------------------
- * Summary: This function assigned a unique (hopefully) hash value for each word, by running through each 
- * character in the word and multiplying its value by 31 and adding those values up.
- * Runtime: O(1);
+ * Summary: Copies a string into the arena and points the slot at it.
+ * Runtime: O(length of the string)
  */
-unsigned strhash(char *s) {
-	unsigned hash = 0;
-	while (*s != 0) {
-		hash = 31 * hash + *s ++;
+static inline void putKey(SET *sp, SLOT *slot, char *elt, size_t len) {
+	pointTo(slot, store(sp, elt, len));
+}
+#else
+/*
+ * Function: *keyOf
+ * -------------------------------
+ * Summary: Returns the string in a slot: the slot itself for a short string, or what it points to for a long one.
+ * Runtime: O(1)
+ */
+static inline char *keyOf(SET *sp, SLOT *slot) {
+	char *s;
+	if (slot->text[SHORT-1] != LONG) {
+		return slot->text;
 	}
-	return hash;
+	memcpy(&s, slot->text, sizeof(s));
+	return (char *) (sp->base + (uintptr_t) s);
 }
 
 /*
- * Function: *createSet
+ * Function: pointTo
+ * -------------------------------
+ * Summary: Makes a slot hold a pointer to a long string.
+ * Runtime: O(1)
+ */
+static inline void pointTo(SLOT *slot, char *s) {
+	memcpy(slot->text, &s, sizeof(s));
+	slot->text[SHORT-1] = LONG;
+}
+
+/*
+ * Function: isLong
+ * -------------------------------
+ * Summary: Returns whether the string in a slot is in the arena rather than the slot.
+ * Runtime: O(1)
+ */
+static inline bool isLong(SLOT *slot) {
+	return slot->text[SHORT-1] == LONG;
+}
+
+/*
+ * Function: keyLength
+ * -------------------------------
+ * Summary: Returns the length of the string in a slot, which the last byte tells us for a short one.
+ * Runtime: O(1) for a short string
+ */
+static inline size_t keyLength(SET *sp, SLOT *slot) {
+	if (isLong(slot)) {
+		return strlen(keyOf(sp, slot));
+	}
+	return SHORT - 1 - slot->text[SHORT-1];
+}
+
+/*
+ * Function: makeKey
+ * -------------------------------
+ * Summary: Prepares elt for a search: if it is short, key becomes exactly what its slot would hold, so it can be
+ * compared with a slot in one go. If it is long, key is just marked LONG.
+ * Runtime: O(1)
+ */
+static inline void makeKey(SLOT *key, char *elt, size_t len) {
+	memset(key, 0, sizeof(SLOT));
+	if (len < SHORT) {
+		memcpy(key->text, elt, len);
+		key->text[SHORT-1] = SHORT - 1 - len;
+	}
+	else {
+		key->text[SHORT-1] = LONG;
+	}
+}
+
+/*
+ * Function: matches
+ * -------------------------------
+ * Summary: Returns whether the string in a slot is elt. A short elt only has to be compared with the slot
+ * (made into key by makeKey), and a long one only with the strings the slots point to.
+ * Runtime: O(1) for a short string
+ */
+static inline bool matches(SET *sp, SLOT *slot, char *elt, SLOT *key) {
+	if (key->text[SHORT-1] != LONG) {
+		return memcmp(slot, key, sizeof(SLOT)) == 0;
+	}
+	return isLong(slot) && strcmp(keyOf(sp, slot), elt) == 0;
+}
+
+/*
+ * Function: putKey
+ * -------------------------------
+ * Summary: Puts a string in a slot if it is short, or copies it into the arena and points the slot at it.
+ * Runtime: O(length of the string)
+ */
+static inline void putKey(SET *sp, SLOT *slot, char *elt, size_t len) {
+	if (len < SHORT) {
+		makeKey(slot, elt, len);
+	}
+	else {
+		pointTo(slot, store(sp, elt, len));
+	}
+}
+#endif
+
+/*
+ * Function: tagOf
+ * -------------------------------
+ * Summary: Returns the flag for a FILLED slot holding an element with the given hash: the FILLED bit
+ * and seven bits of the hash. The hash is multiplied first so that the top bits depend on every
+ * character, not just the first few.
+ * Runtime: O(1)
+ */
+static inline char tagOf(unsigned hash) {
+	return FILLED | (hash * 0x9E3779B1u) >> 25;
+}
+
+/*
+ * Function: setFlag
+ * -------------------------------
+ * Summary: Sets the flag of a slot and of its copies past the end of the array.
+ * Runtime: O(1)
+ */
+static inline void setFlag(char *flags, int length, int locn, char flag) {
+	int i;
+	flags[locn] = flag;
+	for (i = locn + length; i < length + GROUP; i += length) {
+		flags[i] = flag;
+	}
+}
+
+/*
+ * Function: matchMask
+ * -------------------------------
+ * Summary: Returns a bit mask with bit i set if p[i] is equal to flag, for the GROUP flags at p.
+ * Runtime: O(1)
+ */
+static inline unsigned matchMask(char *p, char flag) {
+#ifdef __SSE2__
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *) p), _mm_set1_epi8(flag)));
+#else
+	unsigned mask = 0;
+	int i;
+	for (i = 0; i < GROUP; i++) {
+		mask |= (unsigned) (p[i] == flag) << i;
+	}
+	return mask;
+#endif
+}
+
+/*
+ * Function: *createHashedSet
  * -------------------------------
  * Summary: This function allocates memory and creates a set that keeps track of the number of elements,
  * the length of the array, and the array itself (called "data"). In addition, we create an additional
- * array called flags and initialize each of its elements to EMPTY.
- * Runtime: O(n)
+ * array called flags and initialize each of its elements to EMPTY. maxElts is only a hint now: the
+ * array starts big enough to hold that many elements under MAX_LOAD and grows from there. The strings
+ * are hashed with the given hash function (see hash.h) and seed.
+ * Runtime: O(1)
  */
-SET *createSet(int maxElts){
+SET *createHashedSet(int maxElts, HASHFUNC hash, unsigned long seed){
 	SET *sp;
 
 	sp=malloc(sizeof(SET));						// declare set and allocate memory
 	assert(sp!=NULL);
 
 	sp->count = 0;								// this count element keeps track of the number of elements currently in the set
-	sp->length=maxElts;							// this is the length of the array
-	sp->data = malloc(sizeof(char*)*maxElts);	// this is an character array where the actual data is stored
-	sp->flags = malloc(sizeof(char)*maxElts);
-	int i;
-	for (i = 0; i < maxElts; i++) {				// run through array and initialize each element to EMPTY
-		sp->flags[i] = EMPTY;
+	sp->length = maxElts*100/MAX_LOAD+1;		// this is the length of the array
+	if (sp->length < MIN_LENGTH) {
+		sp->length = MIN_LENGTH;
 	}
-	assert(sp->data!=NULL);
+	sp->data = malloc(sizeof(SLOT)*sp->length);	// this is an character array where the actual data is stored
+	sp->flags = calloc(sp->length+GROUP, sizeof(char));	// every flag starts out EMPTY (calloc gets zeroed pages for free)
+	assert(sp->data!=NULL && sp->flags!=NULL);
+	sp->deleted = 0;
+	sp->oldcount = 0;
+	sp->oldlength = 0;
+	sp->olddata = NULL;
+	sp->oldflags = NULL;
+	sp->moved = 0;
+	sp->hash = hash;
+	sp->seed = seed;
+	sp->chunks = NULL;
+	sp->live = 0;
+	sp->garbage = 0;
+	sp->base = 0;
+	sp->frozen = false;
+	sp->mapping = NULL;
+	sp->mapsize = 0;
 	return sp;
 }
 
+/*
+ * Function: *createSet
+ * -------------------------------
+ * Summary: Creates a set that hashes with wyHash and a seed of zero, so the layout is the same every run.
+ * Runtime: O(1)
+ */
+SET *createSet(int maxElts){
+	return createHashedSet(maxElts, wyHash, 0);
+}
+
+/*
+ * Function: freeChunks
+ * --------------------------------
+ * Summary: Frees a list of arena chunks.
+ * Runtime: O(number of chunks)
+ */
+static void freeChunks(struct chunk *cp){
+	struct chunk *next;
+
+	while (cp != NULL){
+		next = cp->next;
+		free(cp);
+		cp = next;
+	}
+}
+
 /*
  * Function: destroySet
  * --------------------------------
- * Summary: Destroys the set by freeing all the memory starting with the members of the character array, 
- * the character array itself, the flags array, and then the set
- * Runtime: O(n)
+ * Summary: Destroys the set by freeing the arena that holds all the strings, the character array, the flags
+ * array, and then the set. If we are in the middle of a resize, the old arrays are freed too. If the set was
+ * loaded from a snapshot, the file is unmapped.
+ * Runtime: O(number of chunks)
  */
 void destroySet(SET *sp){
+	freeChunks(sp->chunks);				// the strings all live in the arena
+	free(sp->oldflags);
+	free(sp->olddata);
+	if (!sp->frozen) {
+		free(sp->flags);				// free the flags array
+		free(sp->data);					// we then free the data array
+	}
+	if (sp->mapping != NULL) {
+		munmap(sp->mapping, sp->mapsize);
+	}
+	free(sp);							// finally we free the set
+}
+
+/*
+ * Function: *store
+ * --------------------------------
+ * Summary: Copies a string of the given length into the arena and returns the copy. If the newest chunk does not have room, a new one
+ * is allocated that is twice as big (from MIN_CHUNK up to MAX_CHUNK bytes, or just big enough for a longer string),
+ * and whatever was left at the end of the full one is given up.
+ * Runtime: O(length of the string)
+ */
+static char *store(SET *sp, char *elt, size_t len){
+	size_t size;
+	struct chunk *cp = sp->chunks;
+	char *s;
+
+	len++;											// the null byte too
+	if (cp == NULL || cp->size - cp->used < len){
+		size = cp == NULL ? MIN_CHUNK : cp->size * 2 < MAX_CHUNK ? cp->size * 2 : MAX_CHUNK;
+		if (size < len){
+			size = len;
+		}
+		cp = malloc(sizeof(struct chunk) + size);
+		assert(cp!=NULL);
+		cp->next = sp->chunks;
+		cp->used = 0;
+		cp->size = size;
+		sp->chunks = cp;
+	}
+	s = cp->text + cp->used;
+	memcpy(s, elt, len);
+	cp->used += len;
+	sp->live += len;
+	return s;
+}
+
+/*
+ * Function: compact
+ * --------------------------------
+ * Summary: Copies every long element into a fresh arena, in slot order (old array first), and frees the old arena
+ * along with the bytes of all the removed strings in it.
+ * Runtime: O(n)
+ */
+static void compact(SET *sp){
+	struct chunk *chunks = sp->chunks;
 	int i;
 
-	// we first free memory of the elements themselves by checking to see whether the element in the corresponding flags array is FILLED
-	for (i=0;i<sp->length;i++){	
-		if (sp->flags[i]==FILLED){
-			free(sp->data[i]);
+	sp->chunks = NULL;
+	sp->live = 0;
+	sp->garbage = 0;
+	for (i=0;i<sp->oldlength;i++){
+		if ((sp->oldflags[i] & FILLED) && isLong(&sp->olddata[i])){
+			putKey(sp, &sp->olddata[i], keyOf(sp, &sp->olddata[i]), keyLength(sp, &sp->olddata[i]));
 		}
 	}
-	free(sp->flags);					// free the flags array
-	free(sp->data);						// we then free the data array
-	free(sp);							// finally we free the set
+	for (i=0;i<sp->length;i++){
+		if ((sp->flags[i] & FILLED) && isLong(&sp->data[i])){
+			putKey(sp, &sp->data[i], keyOf(sp, &sp->data[i]), keyLength(sp, &sp->data[i]));
+		}
+	}
+	freeChunks(chunks);
 }
 
 /*
@@ -99,97 +499,408 @@ int numElements(SET *sp){
 }
 
 /*
- * Function: search
+ * Function: probe
  * ------------------------------------
- * Summary: This search function performs a search using linear probing. It starts by assigning a starting hash value and keeps
- * track of a deleted location. We then loop through the array checking to see if the locations are FILLED, DELETED, or EMPTY.
- * If FILLED, then we have found the element and simply return its index. If DELETED, then we remember the first deleted location.
- * Otherwise, if it is not the above options,it must be EMPTY, and we have not found the element. If we have not seen a deleted location
- * previously, we return the empty index all the way at the end. Otherwise, we return the first deleted location/index.
+ * Summary: This performs a search of one array using linear probing, a GROUP of slots at a time. Starting at the hash
+ * value, we get masks of the flags in the group that match the tag of elt, that are EMPTY, and that are DELETED. Only
+ * the slots whose tag matches are compared with matches, and if one is equal we have found the element and return its index.
+ * Otherwise, if the group has an EMPTY slot, the element is not in the array, and we return the first DELETED location we
+ * have seen, or that EMPTY location if there was none. Only the slots before the first EMPTY one count. If elt is NULL we
+ * just want a place to put a new element.
  * Runtime Expected/Worst: O(1)/O(n)
  */
-int search (SET *sp, char *elt, bool *found) {
-	int head = strhash(elt)%sp->length;
-	int i, locn;
+static int probe(SET *sp, SLOT *data, char *flags, int length, unsigned hash, char *elt, SLOT *key, bool *found) {
+	int locn = hash%length;
+	char tag = tagOf(hash);
+	int i, j;
 	int deletedlocn=-1;
-	for (i = 0; i < sp->length; i++) {					// looping through the array
-		locn = (head + i)%sp->length;					// but now we start with the hash value.
-		if (sp->flags[locn] == FILLED) {				// FILLED means found, so return location/index
-			if (strcmp(sp->data[locn],elt)==0){
+	unsigned match, empty, deleted, before;
+
+	for (i = 0; i < length; i += GROUP) {			// looping through the array a group at a time
+		empty = matchMask(flags + locn, EMPTY);
+		before = empty != 0 ? (empty & -empty) - 1 : 0xFFFF;	// the slots before the first EMPTY one
+		match = elt != NULL ? matchMask(flags + locn, tag) & before : 0;
+		while (match != 0) {						// same tag, so it is probably the element
+			j = (locn + __builtin_ctz(match))%length;
+			if (matches(sp, &data[j], elt, key)){
 				*found = true;
-				return locn;
+				return j;
 			}
+			match &= match - 1;
 		}
-		else if (sp->flags[locn]==DELETED) {			// DELETED means it still could be further down in the array
-			if (deletedlocn==-1) {						// so we just remember the first DELETED location
-				deletedlocn = locn;
+		if (deletedlocn == -1) {					// DELETED means it still could be further down in the array
+			deleted = matchMask(flags + locn, DELETED) & before;
+			if (deleted != 0) {						// so we just remember the first DELETED location
+				deletedlocn = (locn + __builtin_ctz(deleted))%length;
 			}
 		}
-		else {											// must be EMPTY
-			break;
+		if (empty != 0) {							// EMPTY means it is not in the array
+			*found = false;
+			return deletedlocn != -1 ? deletedlocn : (locn + __builtin_ctz(empty))%length;
+		}
+		locn = (locn + GROUP)%length;
+	}
+	*found = false;									// we have not found the element and there is no EMPTY slot
+	return deletedlocn;
+}
+
+/*
+ * Function: search
+ * ------------------------------------
+ * Summary: Searches for the element in the array and, if we are in the middle of a resize, in the old
+ * array too. If found, *old says which array it is in. If not, the index returned is where it should go
+ * in the (new) array; nothing is ever added to the old one. The caller hashes elt and makes its key, so the
+ * hash can be used again for the new flag.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static int search(SET *sp, char *elt, SLOT *key, unsigned hash, bool *found, bool *old) {
+	int locn = probe(sp, sp->data, sp->flags, sp->length, hash, elt, key, found);
+	int oldlocn;
+
+	*old = false;
+	if (!*found && sp->oldcount > 0) {
+		oldlocn = probe(sp, sp->olddata, sp->oldflags, sp->oldlength, hash, elt, key, found);
+		if (*found) {
+			*old = true;
+			return oldlocn;
+		}
+	}
+	return locn;
+}
+
+/*
+ * Function: migrate
+ * ------------------------------------
+ * Summary: Moves up to steps slots of the old array over to the new one. A moved slot is marked DELETED
+ * rather than EMPTY so the probe sequences of the elements still waiting behind it stay intact. Since
+ * an element is only ever in one of the arrays, we can put it in the first free slot without checking
+ * for a duplicate. Once the whole old array has been moved it is freed.
+ * Runtime: O(steps)
+ */
+static void migrate(SET *sp, int steps) {
+	bool found;
+	int locn;
+	SLOT *slot;
+
+	while (steps-- > 0 && sp->moved < sp->oldlength) {
+		if (sp->oldflags[sp->moved] & FILLED) {
+			slot = &sp->olddata[sp->moved];
+			locn = probe(sp, sp->data, sp->flags, sp->length, hashOf(sp, keyOf(sp, slot), keyLength(sp, slot)), NULL, NULL, &found);
+			if (sp->flags[locn] == DELETED) {
+				sp->deleted--;
+			}
+			sp->data[locn] = sp->olddata[sp->moved];
+			setFlag(sp->flags, sp->length, locn, sp->oldflags[sp->moved]);	// the tag moves with the element
+			setFlag(sp->oldflags, sp->oldlength, sp->moved, DELETED);
+			sp->oldcount--;
+		}
+		sp->moved++;
+	}
+	if (sp->oldlength > 0 && sp->moved == sp->oldlength) {
+		free(sp->olddata);
+		free(sp->oldflags);
+		sp->olddata = NULL;
+		sp->oldflags = NULL;
+		sp->oldlength = 0;
+		sp->moved = 0;
+	}
+}
+
+/*
+ * Function: resize
+ * ------------------------------------
+ * Summary: Starts moving the elements into a new array of the given length. The current array becomes
+ * the old one and is moved over a little at a time by migrate. If a previous resize has not finished
+ * yet, we finish it first (the thresholds make that rare).
+ * Runtime: O(1), or O(n) if a resize is still in progress
+ */
+static void resize(SET *sp, int length) {
+	migrate(sp, sp->oldlength);
+
+	sp->olddata = sp->data;
+	sp->oldflags = sp->flags;
+	sp->oldlength = sp->length;
+	sp->oldcount = sp->count;
+	sp->moved = 0;
+
+	sp->length = length;
+	sp->data = malloc(sizeof(SLOT)*length);
+	sp->flags = calloc(length+GROUP, sizeof(char));
+	assert(sp->data!=NULL && sp->flags!=NULL);
+	sp->deleted = 0;
+}
+
+/*
+ * Function: checkLoad
+ * ------------------------------------
+ * Summary: Called after every change. If too many slots are in use (FILLED or DELETED) we resize: to twice
+ * the length if the elements alone are over half of MAX_LOAD, otherwise to the same length, which just
+ * clears out the DELETED slots. If the elements fall under MIN_LOAD we shrink to half the length.
+ * Runtime: O(1)
+ */
+static void checkLoad(SET *sp) {
+	long used = sp->count - sp->oldcount + sp->deleted;
+
+	if (used*100 > (long) sp->length*MAX_LOAD) {
+		if ((long) sp->count*200 > (long) sp->length*MAX_LOAD) {
+			resize(sp, sp->length*2);
+		}
+		else {
+			resize(sp, sp->length);
+		}
+	}
+	else if ((long) sp->count*100 < (long) sp->length*MIN_LOAD && sp->length/2 >= MIN_LENGTH) {
+		resize(sp, sp->length/2);
+	}
+}
+
+/*
+ * Function: thaw
+ * ------------------------------------
+ * Summary: Called before the first change to a set loaded from a snapshot. The slots and flags are copied out of
+ * the file into arrays of our own, and each long slot is pointed at its string in the file, which stays mapped
+ * and is treated like a chunk of the arena from then on (compacting will copy the strings out of it).
+ * Runtime: O(n)
+ */
+static void thaw(SET *sp) {
+	SLOT *data = sp->data;
+	char *flags = sp->flags;
+	int i;
+
+	sp->data = malloc(sizeof(SLOT)*sp->length);
+	sp->flags = malloc(sp->length+GROUP);
+	assert(sp->data!=NULL && sp->flags!=NULL);
+	memcpy(sp->data, data, sizeof(SLOT)*sp->length);
+	memcpy(sp->flags, flags, sp->length+GROUP);
+	for (i=0;i<sp->length;i++){
+		if ((sp->flags[i] & FILLED) && isLong(&sp->data[i])){
+			pointTo(&sp->data[i], keyOf(sp, &sp->data[i]));
 		}
 	}
-	*found = false;										// we have not found the element
-	if (deletedlocn == -1) {							// so if we haven not seen a deleted location, return that new empty location at the end
-		return locn;
+	sp->base = 0;
+	sp->frozen = false;
+}
+
+/*
+ * Function: insertAt
+ * -------------------------------------
+ * Summary: Puts an element that a search did not find at the index in the (new) array where the search said it
+ * should go, and sets its flag.
+ * Runtime: O(1) amortized
+ */
+static void insertAt(SET *sp, int index, char *elt, size_t len, unsigned hash){
+	assert(index >= 0);							// the set is full
+	if (sp->flags[index] == DELETED) {
+		sp->deleted--;
+	}
+	putKey(sp, &sp->data[index], elt, len);	// same as previous lab, but now we have to update the flags array to FILLED
+	setFlag(sp->flags, sp->length, index, tagOf(hash));
+	sp->count++;
+	checkLoad(sp);
+}
+
+/*
+ * Function: removeAt
+ * ------------------------------------
+ * Summary: Removes the element of length len that a search found at the index, in the old array if old is set.
+ * Its bytes in the arena (if any) become garbage, and we set the corresponding flag to DELETED. If the garbage now
+ * outweighs the live strings (and a chunk), the arena is compacted, which moves the other strings too.
+ * Runtime: O(1) amortized
+ */
+static void removeAt(SET *sp, int index, bool old, size_t len){
+	if (isLong(old ? &sp->olddata[index] : &sp->data[index])) {	// its bytes in the arena are now garbage
+		sp->live -= len + 1;
+		sp->garbage += len + 1;
+	}
+	if (old) {									// it has not been moved over yet
+		setFlag(sp->oldflags, sp->oldlength, index, DELETED);
+		sp->oldcount--;
+	}
+	else {
+		setFlag(sp->flags, sp->length, index, DELETED);	// now we set the flag in the same index of the flags array to DELETED
+		sp->deleted++;
+	}
+	sp->count--;
+	checkLoad(sp);
+	if (sp->garbage > sp->live + MIN_CHUNK) {
+		compact(sp);
 	}
-	return deletedlocn;									// otherwise, return the first deleted location/index
 }
 
 /*
  * Function: addElement
  * -------------------------------------
- * Summary: Searches using linear probing for the element. We use a bool to keep track of whether it's been 
+ * Summary: Searches using linear probing for the element. We use a bool to keep track of whether it's been
  * found. If not found, we insert the element in that spot and set the corresponding flag to FILLED.
  * Runtime Expected/Worst: O(1)/O(n)
  */
 void addElement(SET *sp, char *elt){
 	assert(sp!=NULL && elt!=NULL);
-	bool searched;
-	int index = search(sp, elt, &searched);			// the index where the element should go
+	bool searched, old;
+	size_t len = strlen(elt);
+	unsigned hash = hashOf(sp, elt, len);
+	SLOT key;
+	makeKey(&key, elt, len);
+	if (sp->frozen) {
+		thaw(sp);
+	}
+	migrate(sp, MIGRATE_STEP);
+	int index = search(sp, elt, &key, hash, &searched, &old);	// the index where the element should go
 	if(searched==false) {
-		sp->data[index]=strdup(elt);				// same as previous lab, but now we have to update the flags array to FILLED
-		sp->flags[index] = FILLED;
-		sp->count++;
+		insertAt(sp, index, elt, len, hash);
 	}
 }
 
 /*
  * Function: removeElement
  * ------------------------------------
- * Summary: Searches using linear probing for the element. If found, we free the memory at the location, 
- * and set the corresponding flag to DELETED
+ * Summary: Searches using linear probing for the element, and removes it if found.
  * Runtime Expected/Worst: O(1)/O(n)
  */
 void removeElement(SET *sp, char *elt){
 	assert(sp!=NULL && elt!=NULL);
-	bool searched;
-	int index = search(sp, elt, &searched);			// index where the element should go
+	bool searched, old;
+	size_t len = strlen(elt);
+	SLOT key;
+	makeKey(&key, elt, len);
+	if (sp->frozen) {
+		thaw(sp);
+	}
+	migrate(sp, MIGRATE_STEP);
+	int index = search(sp, elt, &key, hashOf(sp, elt, len), &searched, &old);	// index where the element should go
+	if(searched==true) {
+		removeAt(sp, index, old, len);
+	}
+}
+
+/*
+ * Function: toggle
+ * ------------------------------------
+ * Summary: Removes the element if it is in the set and adds it if not. A search that misses already says where the
+ * element should go, so one search does for both. The caller has already hashed the element. Returns whether the
+ * element was added.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+static bool toggle(SET *sp, char *elt, size_t len, unsigned hash){
+	bool searched, old;
+	SLOT key;
+	makeKey(&key, elt, len);
+	if (sp->frozen) {
+		thaw(sp);
+	}
+	migrate(sp, MIGRATE_STEP);
+	int index = search(sp, elt, &key, hash, &searched, &old);
 	if(searched==true) {
-		free(sp->data[index]);						// free the memory at index essentially deleting it
-		sp->flags[index] = DELETED;					// now we set the flag in the same index of the flags array to DELETED
-		sp->count--;
+		removeAt(sp, index, old, len);
 	}
+	else {
+		insertAt(sp, index, elt, len, hash);
+	}
+	return !searched;
+}
+
+/*
+ * Function: toggleElement
+ * ------------------------------------
+ * Summary: Hashes the element and toggles it (see toggle). Returns whether the element was added.
+ * Runtime Expected/Worst: O(1)/O(n)
+ */
+bool toggleElement(SET *sp, char *elt){
+	assert(sp!=NULL && elt!=NULL);
+	size_t len = strlen(elt);
+	return toggle(sp, elt, len, hashOf(sp, elt, len));
 }
 
 /*
  * Function: *findElement
  * -------------------------------------
- * Summary: Uses the search function. If search is true, then we have found the element and return the 
- * element. Otherwise, return NULL.
+ * Summary: Uses the search function. If search is true, then we have found the element and return the
+ * element. Otherwise, return NULL. The string returned lives in the slot or the arena, so it may move when
+ * an element is added or removed.
  * Runtime Expected/Worst: O(1)/O(n)
  */
 char *findElement(SET *sp, char *elt){
 	assert(sp!=NULL && elt!=NULL);
-	bool searched;
-	int index = search(sp, elt, &searched);
+	bool searched, old;
+	size_t len = strlen(elt);
+	SLOT key;
+	makeKey(&key, elt, len);
+	int index = search(sp, elt, &key, hashOf(sp, elt, len), &searched, &old);
 	if (searched==true){
-		return sp->data[index];
+		return keyOf(sp, old ? &sp->olddata[index] : &sp->data[index]);
 	}
 	else {
 		return NULL;
 	}
 }
+/*
+ * Function: findElements
+ * -------------------------------------
+ * Summary: Looks up n elements at once and stores the match for each (or NULL) in results. They are taken BATCH at a
+ * time: first every element of the batch is hashed and the flags and slot at its home are prefetched, and only then
+ * are the probes done, so the cache misses of the whole batch are waited on together rather than one after another.
+ * The results are the same as findElement's, and move the same way.
+ * Runtime Expected/Worst: O(n)/O(n * length of array)
+ */
+void findElements(SET *sp, char **elts, int n, char **results){
+	assert(sp!=NULL && (n==0 || (elts!=NULL && results!=NULL)));
+	unsigned hashes[BATCH];
+	size_t lens[BATCH];
+	bool searched, old;
+	int i, j, m, index;
+	SLOT key;
+
+	for (i = 0; i < n; i += BATCH) {
+		m = n - i < BATCH ? n - i : BATCH;
+		for (j = 0; j < m; j++) {					// hash them all and start loading their homes
+			lens[j] = strlen(elts[i+j]);
+			hashes[j] = hashOf(sp, elts[i+j], lens[j]);
+			index = hashes[j]%sp->length;
+			__builtin_prefetch(&sp->flags[index]);
+			__builtin_prefetch(&sp->data[index]);
+		}
+		for (j = 0; j < m; j++) {					// by now most of them are in the cache
+			makeKey(&key, elts[i+j], lens[j]);
+			index = search(sp, elts[i+j], &key, hashes[j], &searched, &old);
+			results[i+j] = searched ? keyOf(sp, old ? &sp->olddata[index] : &sp->data[index]) : NULL;
+		}
+	}
+}
+
+/*
+ * Function: toggleElements
+ * -------------------------------------
+ * Summary: Toggles n elements in order, as toggleElement does, and stores whether each was added in added (if it is
+ * not NULL). As in findElements, every element of a BATCH is hashed and its home prefetched first, and then each is
+ * toggled with a single search. An element may be toggled again by a copy of it later in the same batch, which is
+ * fine since the hash does not change and the search is done then.
+ * Runtime Expected/Worst: O(n)/O(n * length of array)
+ */
+void toggleElements(SET *sp, char **elts, int n, bool *added){
+	assert(sp!=NULL && (n==0 || elts!=NULL));
+	unsigned hashes[BATCH];
+	size_t lens[BATCH];
+	int i, j, m, index;
+	bool result;
+
+	for (i = 0; i < n; i += BATCH) {
+		m = n - i < BATCH ? n - i : BATCH;
+		for (j = 0; j < m; j++) {					// hash them all and start loading their homes
+			lens[j] = strlen(elts[i+j]);
+			hashes[j] = hashOf(sp, elts[i+j], lens[j]);
+			index = hashes[j]%sp->length;
+			__builtin_prefetch(&sp->flags[index]);
+			__builtin_prefetch(&sp->data[index]);
+		}
+		for (j = 0; j < m; j++) {
+			result = toggle(sp, elts[i+j], lens[j], hashes[j]);
+			if (added != NULL) {
+				added[i+j] = result;
+			}
+		}
+	}
+}
+
 /*
  * Function: **getElements
  * ----------------------------------
@@ -198,14 +909,173 @@ char *findElement(SET *sp, char *elt){
  */
 char **getElements(SET *sp){
 	assert(sp!=NULL);
-	char **arr;
+	char **arr, *elt;
 	int lastIndex = 0;
+	CURSOR cursor;
 	arr = malloc(sizeof(char*)*sp->count);		// declare array and allocate memory to be size of the number of elements
-	for (int i = 0;i < sp->length;i++){
-		if (sp->flags[i] == FILLED){						// we only want an array of elements and not the entire thing so check if FILLED
-			arr[lastIndex]=strdup(sp->data[i]);				// copy the data
-			lastIndex++;
-		}
+	beginElements(sp, &cursor);					// the cursor knows to look in both arrays
+	while ((elt = nextElement(&cursor)) != NULL){
+		arr[lastIndex]=strdup(elt);				// copy the data
+		lastIndex++;
 	}
 	return arr;
 }
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor before the first element so nextElement can walk the set in place,
+ * without the array getElements allocates. The set must not change while it is being walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->index = 0;
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the next element, or NULL when there are none left, by moving the cursor along to
+ * the next FILLED slot. During a resize the cursor walks the old array first and then the new one.
+ * Runtime: O(1) amortized
+ */
+char *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	SET *sp = cp->set;
+	int index;
+
+	while (cp->index < sp->oldlength + sp->length){
+		index = cp->index++;
+		if (index < sp->oldlength){
+			if (sp->oldflags[index] & FILLED)
+				return keyOf(sp, &sp->olddata[index]);
+		}
+		else if (sp->flags[index - sp->oldlength] & FILLED){
+			return keyOf(sp, &sp->data[index - sp->oldlength]);
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Function: saveSet
+ * ----------------------------------
+ * Summary: Writes the set to a snapshot file that loadSet can map back in: a header, the slots with the offset of
+ * each long string in place of its pointer, the flags, and then the long strings packed one after another in slot
+ * order. Any resize in progress is finished first. The file is written under a temporary name and then renamed,
+ * so a set loaded from the old file (even this one) keeps working and nobody can load half a snapshot. Returns 0
+ * if the file cannot be written or the hash function has no name (see hashName), and 1 otherwise.
+ * Runtime: O(n)
+ */
+int saveSet(SET *sp, char *path){
+	assert(sp!=NULL && path!=NULL);
+	static char padding[GROUP];
+	struct header header;
+	size_t offset = 0;
+	char *name;
+	SLOT slot;
+	char temp[strlen(path) + 5];
+	FILE *fp;
+	int i, failed;
+
+	migrate(sp, sp->oldlength);
+	if ((name = hashName(sp->hash)) == NULL || (fp = fopen(strcat(strcpy(temp, path), ".tmp"), "wb")) == NULL){
+		return 0;
+	}
+	memset(&header, 0, sizeof(header));
+	strcpy(header.magic, MAGIC);
+	header.order = ORDER;
+	header.slot = sizeof(SLOT);
+	header.count = sp->count;
+	header.length = sp->length;
+	header.deleted = sp->deleted;
+	strcpy(header.hash, name);
+	header.seed = sp->seed;
+	header.strings = sp->live;						// the live bytes of the arena are exactly the long strings
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(padding, ALIGN(sizeof(header)) - sizeof(header), 1, fp);
+
+	for (i=0;i<sp->length;i++){
+		memset(&slot, 0, sizeof(SLOT));
+		if ((sp->flags[i] & FILLED) && isLong(&sp->data[i])){
+			pointTo(&slot, (char *) offset);
+			offset += keyLength(sp, &sp->data[i]) + 1;
+		}
+		else if (sp->flags[i] & FILLED){
+			slot = sp->data[i];
+		}
+		fwrite(&slot, sizeof(SLOT), 1, fp);
+	}
+	assert(offset == header.strings);
+	fwrite(sp->flags, sp->length+GROUP, 1, fp);
+
+	for (i=0;i<sp->length;i++){
+		if ((sp->flags[i] & FILLED) && isLong(&sp->data[i])){
+			fwrite(keyOf(sp, &sp->data[i]), keyLength(sp, &sp->data[i]) + 1, 1, fp);
+		}
+	}
+	failed = ferror(fp);
+	if (fclose(fp) != 0 || failed || rename(temp, path) != 0){
+		remove(temp);
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Function: *loadSet
+ * ----------------------------------
+ * Summary: Maps a snapshot file written by saveSet into memory and returns a set whose slots and flags are the ones
+ * in the file, so nothing is read until it is searched. Returns NULL if the file cannot be opened or is not a
+ * snapshot from this implementation on this kind of machine. The contents of the slots are trusted.
+ * Runtime: O(1)
+ */
+SET *loadSet(char *path){
+	assert(path!=NULL);
+	struct header *hp;
+	struct stat st;
+	char *mapping;
+	size_t slots, flags, strings;
+	SET *sp;
+	int fd;
+
+	if ((fd = open(path, O_RDONLY)) < 0){
+		return NULL;
+	}
+	mapping = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= sizeof(struct header)){
+		mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if (mapping == MAP_FAILED){
+		return NULL;
+	}
+
+	hp = (struct header *) mapping;
+	slots = ALIGN(sizeof(struct header));
+	flags = slots + sizeof(SLOT)*(size_t) hp->length;
+	strings = flags + hp->length + GROUP;
+	if (memcmp(hp->magic, MAGIC, sizeof(MAGIC)) != 0 || hp->order != ORDER || hp->slot != sizeof(SLOT) || hp->length < MIN_LENGTH ||
+			hp->hash[sizeof(hp->hash)-1] != '\0' || findHash(hp->hash) == NULL || strings + hp->strings != st.st_size){
+		munmap(mapping, st.st_size);
+		return NULL;
+	}
+	madvise(mapping, st.st_size, MADV_RANDOM);		// searches jump all over the table
+
+	sp = createHashedSet(0, findHash(hp->hash), hp->seed);
+	free(sp->data);
+	free(sp->flags);
+	sp->count = hp->count;
+	sp->length = hp->length;
+	sp->deleted = hp->deleted;
+	sp->data = (SLOT *) (mapping + slots);
+	sp->flags = mapping + flags;
+	sp->live = hp->strings;
+	sp->base = (uintptr_t) (mapping + strings);
+	sp->frozen = true;
+	sp->mapping = mapping;
+	sp->mapsize = st.st_size;
+	return sp;
+}
@@ -12,19 +12,181 @@
  *              total words in the set are printed.  If the second file is
  *              given then all words in the second file are deleted from
  *              the set and the count printed.
+ *
+ *              With -j, the words are sorted by hash into that many sets,
+ *              one per thread, which are then counted together.  With -b,
+ *              the words are looked up BATCH at a time with findElements,
+ *              and only those that need to be are added or removed.
+ *
+ *              With -o, the set is saved to a snapshot file at the end.
+ *              The first file can be such a snapshot instead of text, in
+ *              which case the set is loaded from it as it was saved.  A
+ *              snapshot holds only the set, not the text it was built
+ *              from, so then there is no count of total words to print
+ *              and only the distinct words are counted.
+ *
+ *              With -a, no set is built at all.  The words of every file
+ *              given go into a HyperLogLog sketch of 2^precision registers
+ *              (see hll.h, and -p to change the precision), one per thread
+ *              and file, which are merged, and the estimated number of
+ *              distinct words in all of the files together is printed with
+ *              its standard error.  The memory used does not grow with the
+ *              number of distinct words.
  */
 
 # include <stdio.h>
 # include <stdlib.h>
 # include <string.h>
 # include <stdbool.h>
+# include <pthread.h>
 # include "set.h"
+# include "words.h"
+# include "shard.h"
+# include "snapshot.h"
+# include "hll.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
 
 # define MAX_SIZE 18000
 
+# define BATCH 32
+
+# define MAX_WORD (BUFSIZ - 1)
+
+
+typedef struct {
+    WORDS *wp;
+    SKETCH *sp;
+    long words;
+} PART;
+
+
+/*
+ * Function:    total
+ *
+ * Description: Return the number of elements in the N sets in SETS.
+ */
+
+static int total(SET **sets, int n)
+{
+    int i, count = 0;
+
+
+    for (i = 0; i < n; i ++)
+	count += numElements(sets[i]);
+
+    return count;
+}
+
+
+/*
+ * Function:    batch
+ *
+ * Description: Read the rest of the words of WP, looking them up in SP
+ *		BATCH at a time with findElements, and call APPLY on SP and
+ *		each word that FOUND says whether should be in SP.  Return
+ *		the number of words read.  Adding or removing a word twice is
+ *		harmless, so it does not matter if a copy of a word earlier in
+ *		the same batch has already changed the set.
+ */
+
+static int batch(WORDS *wp, SET *sp, void (*apply)(SET *, char *), bool found)
+{
+    static char buffers[BATCH][BUFSIZ];
+    char *words[BATCH], *results[BATCH];
+    int i, n, total = 0;
+
+
+    for (i = 0; i < BATCH; i ++)
+	words[i] = buffers[i];
+
+    do {
+	for (n = 0; n < BATCH && readWord(wp, words[n], BUFSIZ) == 1; n ++)
+	    ;
+
+	findElements(sp, words, n, results);
+
+	for (i = 0; i < n; i ++)
+	    if ((results[i] != NULL) == found)
+		(*apply)(sp, words[i]);
+
+	total += n;
+    } while (n == BATCH);
+
+    return total;
+}
+
+
+/*
+ * Function:    sketch
+ *
+ * Description: Add the words of the part PP to its sketch, cutting them
+ *		short as readWord with a buffer of BUFSIZ does, and count
+ *		them.  This is the body of each thread for approximate.
+ */
+
+static void *sketch(void *arg)
+{
+    PART *pp = arg;
+    char *word;
+    size_t len;
+
+
+    while ((word = nextWord(pp->wp, &len)) != NULL) {
+	addToSketch(pp->sp, word, len < MAX_WORD ? len : MAX_WORD);
+	pp->words ++;
+    }
+
+    return NULL;
+}
+
+
+/*
+ * Function:    approximate
+ *
+ * Description: Add the words of WP to SP with THREADS threads, each of
+ *		which fills its own sketch from its part of the text, and
+ *		merge those sketches into SP, which has the given PRECISION.
+ *		Return the number of words.
+ */
+
+static long approximate(WORDS *wp, SKETCH *sp, int precision, int threads)
+{
+    WORDS *words[MAX_SHARDS];
+    PART parts[MAX_SHARDS];
+    pthread_t ids[MAX_SHARDS];
+    long total = 0;
+    int i, n;
+
+
+    n = splitWords(wp, words, threads);
+
+    for (i = 0; i < n; i ++) {
+	parts[i].wp = words[i];
+	parts[i].sp = createSketch(precision);
+	parts[i].words = 0;
+
+	if (i > 0)
+	    pthread_create(&ids[i], NULL, sketch, &parts[i]);
+    }
+
+    if (n > 0)
+	sketch(&parts[0]);
+
+    for (i = 0; i < n; i ++) {
+	if (i > 0)
+	    pthread_join(ids[i], NULL);
+
+	mergeSketch(sp, parts[i].sp);
+	destroySketch(parts[i].sp);
+	closeWords(words[i]);
+	total += parts[i].words;
+    }
+
+    return total;
+}
+
 
 /*
  * Function:    main
@@ -34,56 +196,126 @@
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ], **elts;
-    SET *unique;
-    int i, words;
-    bool lflag = false;
+    WORDS *wp;
+    char buffer[BUFSIZ], *word, *output = NULL;
+    SET *unique[MAX_SHARDS];
+    CURSOR cursor;
+    int i, j, words, threads = 1, precision = DEFAULT_PRECISION;
+    bool lflag = false, bflag = false, aflag = false;
+    SKETCH *sp;
+    long count;
 
 
     /* Check usage and open the first file. */
 
-    if (argc > 1 && strcmp(argv[1], "-l") == 0) {
-	lflag = true;
-	argc --;
+    while (argc > 1 && (strcmp(argv[1], "-l") == 0 || strcmp(argv[1], "-b") == 0 ||
+	strcmp(argv[1], "-j") == 0 || strcmp(argv[1], "-o") == 0 ||
+	strcmp(argv[1], "-a") == 0 || strcmp(argv[1], "-p") == 0)) {
+	if (strcmp(argv[1], "-l") == 0) {
+	    lflag = true;
+	    j = 1;
+	} else if (strcmp(argv[1], "-b") == 0) {
+	    bflag = true;
+	    j = 1;
+	} else if (strcmp(argv[1], "-a") == 0) {
+	    aflag = true;
+	    j = 1;
+	} else if (argc > 2 && strcmp(argv[1], "-j") == 0) {
+	    threads = atoi(argv[2]);
+	    j = 2;
+	} else if (argc > 2 && strcmp(argv[1], "-p") == 0) {
+	    precision = atoi(argv[2]);
+	    j = 2;
+	} else if (argc > 2) {
+	    output = argv[2];
+	    j = 2;
+	} else
+	    break;
+
+	argc -= j;
 
 	for (i = 1; i < argc; i ++)
-	    argv[i] = argv[i + 1];
+	    argv[i] = argv[i + j];
     }
 
-    if (argc == 1 || argc > 3) {
-        fprintf(stderr, "usage: %s [-l] file1 [file2]\n", argv[0]);
+    if (argc == 1 || (argc > 3 && !aflag) || threads < 1 || threads > MAX_SHARDS ||
+	(threads > 1 && (output != NULL || bflag)) || precision < MIN_PRECISION ||
+	precision > MAX_PRECISION || (aflag && (lflag || bflag || output != NULL))) {
+        fprintf(stderr, "usage: %s [-l] [-j threads | [-b] [-o snapshot]] file1 [file2]\n", argv[0]);
+        fprintf(stderr, "       %s -a [-p precision] [-j threads] file ...\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
-        fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
-        exit(EXIT_FAILURE);
-    }
 
+    /* Estimate the distinct words of all of the files if desired. */
+
+    if (aflag) {
+	sp = createSketch(precision);
+	count = 0;
 
-    /* Insert all words into the set. */
+	for (i = 1; i < argc; i ++) {
+	    if ((wp = openWords(argv[i])) == NULL) {
+		fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[i]);
+		exit(EXIT_FAILURE);
+	    }
 
-    words = 0;
-    unique = createSet(MAX_SIZE);
+	    count += approximate(wp, sp, precision, threads);
+	    closeWords(wp);
+	}
 
-    while (fscanf(fp, "%s", buffer) == 1) {
-        words ++;
-        addElement(unique, buffer);
+	printf("%ld total words\n", count);
+	printf("%.0f distinct words (estimated, +/- %.2f%%)\n",
+	    estimateSketch(sp), sketchError(sp) * 100);
+	destroySketch(sp);
+	exit(EXIT_SUCCESS);
     }
 
-    fclose(fp);
+    if ((unique[0] = loadSet(argv[1])) != NULL) {
+	if (threads > 1) {
+	    fprintf(stderr, "%s: cannot use -j with a snapshot\n", argv[0]);
+	    exit(EXIT_FAILURE);
+	}
+
+	if (!lflag)
+	    printf("%d distinct words\n", total(unique, threads));
+
+    } else {
+	if ((wp = openWords(argv[1])) == NULL) {
+	    fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
+	    exit(EXIT_FAILURE);
+	}
+
+
+	/* Insert all words into the set. */
+
+	words = 0;
+
+	for (i = 0; i < threads; i ++)
+	    unique[i] = createSet(MAX_SIZE / threads);
 
-    if (!lflag) {
-	printf("%d total words\n", words);
-	printf("%d distinct words\n", numElements(unique));
+	if (threads > 1)
+	    words = shardWords(wp, unique, threads, addElement);
+	else if (bflag)
+	    words = batch(wp, unique[0], addElement, false);
+
+	while (readWord(wp, buffer, BUFSIZ) == 1) {
+	    words ++;
+	    addElement(unique[0], buffer);
+	}
+
+	closeWords(wp);
+
+	if (!lflag) {
+	    printf("%d total words\n", words);
+	    printf("%d distinct words\n", total(unique, threads));
+	}
     }
 
 
     /* Try to open the second file. */
 
     if (argc == 3) {
-        if ((fp = fopen(argv[2], "r")) == NULL) {
+        if ((wp = openWords(argv[2])) == NULL) {
             fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[2]);
             exit(EXIT_FAILURE);
         }
@@ -91,27 +323,40 @@ int main(int argc, char *argv[])
 
         /* Delete all words in the second file. */
 
-        while (fscanf(fp, "%s", buffer) == 1)
-            removeElement(unique, buffer);
+        if (threads > 1)
+	    shardWords(wp, unique, threads, removeElement);
+	else if (bflag)
+	    batch(wp, unique[0], removeElement, true);
 
-	fclose(fp);
+        while (readWord(wp, buffer, BUFSIZ) == 1)
+            removeElement(unique[0], buffer);
+
+	closeWords(wp);
 
 	if (!lflag)
-	    printf("%d remaining words\n", numElements(unique));
+	    printf("%d remaining words\n", total(unique, threads));
     }
 
 
-    /* Print the list of words if desired. */
+    /* Save the set if desired. */
+
+    if (output != NULL && !saveSet(unique[0], output)) {
+	fprintf(stderr, "%s: cannot write %s\n", argv[0], output);
+	exit(EXIT_FAILURE);
+    }
 
-    if (lflag) {
-	elts = getElements(unique);
 
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
+    /* Print the list of words if desired. */
 
-	free(elts);
+    for (i = 0; lflag && i < threads; i ++) {
+	beginElements(unique[i], &cursor);
+
+	while ((word = nextElement(&cursor)) != NULL)
+	    printf("%s\n", word);
     }
 
-    destroySet(unique);
+    for (i = 0; i < threads; i ++)
+	destroySet(unique[i]);
+
     exit(EXIT_SUCCESS);
 }
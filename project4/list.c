@@ -235,6 +235,33 @@ void removeItem(LIST *lp, void *item) {
 	}
 }
 
+/*
+ * Function: *takeItem
+ * --------------------------------------------------
+ * Summary: Like removeItem, but the list may be empty, and the data of the node that was cut out is returned, or
+ * NULL if no node matched. A caller that needs to know whether the item was there can then do it in one walk
+ * down the list instead of calling findItem first.
+ * Runtime: O(n)
+ */
+void *takeItem(LIST *lp, void *item) {
+	assert(lp->compare!=NULL && item!=NULL);
+	int i;
+	void *data;
+	struct node *theNode = lp->head->next;
+	for (i = 0; i < lp->count; i++) {
+		if (lp->compare(theNode->data,item)==0) {
+			theNode->prev->next = theNode->next;
+			theNode->next->prev = theNode->prev;
+			data = theNode->data;
+			free(theNode);
+			lp->count--;
+			return data;
+		}
+		theNode = theNode->next;
+	}
+	return NULL;
+}
+
 /*
  * Function: *findItem
  * --------------------------------------------------
@@ -275,3 +302,21 @@ void *getItems(LIST *lp) {
 	}
 	return arr;
 }
+
+/*
+ * Function: *nextItem
+ * --------------------------------------------------
+ * Summary: Walks the list one item at a time without copying it into an array. *posp keeps our place
+ * between calls and should be NULL for the first call; each call returns the next item's data and
+ * NULL once we are back at the dummy node. The list must not change while it is being walked.
+ * Runtime: O(1)
+ */
+void *nextItem(LIST *lp, void **posp) {
+	assert(lp!=NULL && posp!=NULL);
+	struct node *theNode = *posp == NULL ? lp->head->next : *posp;
+	if (theNode == lp->head) {								// we have gone all the way around
+		return NULL;
+	}
+	*posp = theNode->next;
+	return theNode->data;
+}
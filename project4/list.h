@@ -35,8 +35,12 @@ extern void *getLast(LIST *lp);
 
 extern void removeItem(LIST *lp, void *item);
 
+extern void *takeItem(LIST *lp, void *item);
+
 extern void *findItem(LIST *lp, void *item);
 
 extern void *getItems(LIST *lp);
 
+extern void *nextItem(LIST *lp, void **posp);
+
 # endif /* LIST_H */
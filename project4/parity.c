@@ -16,6 +16,7 @@
 # include <stdlib.h>
 # include <string.h>
 # include "set.h"
+# include "words.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -49,8 +50,8 @@ static unsigned strhash(char *s)
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ], *word;
+    WORDS *wp;
+    char buffer[BUFSIZ], *word, *match;
     SET *odd;
     int words;
 
@@ -62,30 +63,31 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
 
 
-    /* Insert or delete words to compute their parity. */
+    /* Insert or delete words to compute their parity, with one search
+       for each.  The set keeps the copy of a word it adds. */
 
     words = 0;
     odd = createSet(MAX_SIZE, strcmp, strhash);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
+    while (readWord(wp, buffer, BUFSIZ) == 1) {
         words ++;
+        word = strdup(buffer);
 
-        if ((word = findElement(odd, buffer)) != NULL) {
-            removeElement(odd, buffer);
+        if ((match = toggleElement(odd, word)) != NULL) {
+	    free(match);
 	    free(word);
-	} else
-            addElement(odd, strdup(buffer));
+	}
     }
 
     printf("%d total words\n", words);
     printf("%d words occur an odd number of times\n", numElements(odd));
-    fclose(fp);
+    closeWords(wp);
 
     destroySet(odd);
     exit(EXIT_SUCCESS);
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include "list.h"
+#include "set.h"
 #define AVG_LENGTH 20
 
 /*
@@ -97,20 +98,40 @@ void addElement(SET *sp, void *elt){
 /*
  * Function: removeElement
  * ------------------------------------
- * Summary: Like add element, we keep track of the hash location and use findItem to search for the specified
- * element. If found, we use removeItem (written in list.c) to take the node containing that element ouf of 
- * the list.
+ * Summary: Like add element, we keep track of the hash location. Then we use takeItem (written in list.c) to take
+ * the node containing that element out of the list if it is there, which finds it on the same walk.
  * Runtime: O(n)
  */
 void removeElement(SET *sp, void *elt){
 	assert(sp!=NULL && elt!=NULL);
 	int index = (*sp->hash)(elt)%sp->length;
-	if (findItem(sp->lists[index],elt)!=NULL) {			// it is found
-		removeItem(sp->lists[index],elt);
+	if (takeItem(sp->lists[index],elt)!=NULL) {			// it was found
 		sp->count--;
 	}
 }
 
+/*
+ * Function: *toggleElement
+ * ------------------------------------
+ * Summary: Takes the element out of its list if it is there, and otherwise adds elt to the front of the list, so
+ * the list is only walked once. Returns the element that was removed, for the caller to free, or NULL if elt was
+ * added.
+ * Runtime: O(n)
+ */
+void *toggleElement(SET *sp, void *elt){
+	assert(sp!=NULL && elt!=NULL);
+	int index = (*sp->hash)(elt)%sp->length;
+	void *match = takeItem(sp->lists[index],elt);
+	if (match!=NULL) {
+		sp->count--;
+	}
+	else {
+		addFirst(sp->lists[index],elt);
+		sp->count++;
+	}
+	return match;
+}
+
 /*
  * Function: *findElement
  * -------------------------------------
@@ -150,3 +171,39 @@ void *getElements(SET *sp){
 	return arr;
 	
 }
+
+/*
+ * Function: beginElements
+ * ----------------------------------
+ * Summary: Positions a cursor before the first element so nextElement can walk the set in place,
+ * without the array getElements allocates. The set must not change while it is being walked.
+ * Runtime: O(1)
+ */
+void beginElements(SET *sp, CURSOR *cp){
+	assert(sp!=NULL && cp!=NULL);
+	cp->set = sp;
+	cp->index = 0;
+	cp->node = NULL;
+}
+
+/*
+ * Function: *nextElement
+ * ----------------------------------
+ * Summary: Returns the next element, or NULL when there are none left. We walk the list at the current
+ * index (nextItem keeps our place in it) and move on to the next index when it runs out.
+ * Runtime: O(1) amortized
+ */
+void *nextElement(CURSOR *cp){
+	assert(cp!=NULL);
+	SET *sp = cp->set;
+	void *elt;
+
+	while (cp->index < sp->length){
+		if ((elt = nextItem(sp->lists[cp->index], &cp->node)) != NULL){
+			return elt;
+		}
+		cp->index++;									// this list is done, so start on the next one
+		cp->node = NULL;
+	}
+	return NULL;
+}
@@ -14,6 +14,12 @@
 
 typedef struct set SET;
 
+typedef struct cursor {
+    SET *set;
+    int index;
+    void *node;
+} CURSOR;
+
 SET *createSet(int maxElts, int (*compare)(), unsigned (*hash)());
 
 void destroySet(SET *sp);
@@ -24,8 +30,14 @@ void addElement(SET *sp, void *elt);
 
 void removeElement(SET *sp, void *elt);
 
+void *toggleElement(SET *sp, void *elt);
+
 void *findElement(SET *sp, void *elt);
 
 void *getElements(SET *sp);
 
+void beginElements(SET *sp, CURSOR *cp);
+
+void *nextElement(CURSOR *cp);
+
 # endif /* SET_H */
@@ -19,6 +19,7 @@
 # include <string.h>
 # include <stdbool.h>
 # include "set.h"
+# include "words.h"
 
 
 /* This is sufficient for the test cases in /scratch/coen12. */
@@ -52,9 +53,10 @@ static unsigned strhash(char *s)
 
 int main(int argc, char *argv[])
 {
-    FILE *fp;
-    char buffer[BUFSIZ], **elts, *word;
+    WORDS *wp;
+    char buffer[BUFSIZ], *word;
     SET *unique;
+    CURSOR cursor;
     int i, words;
     bool lflag = false;
 
@@ -74,7 +76,7 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    if ((fp = fopen(argv[1], "r")) == NULL) {
+    if ((wp = openWords(argv[1])) == NULL) {
         fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[1]);
         exit(EXIT_FAILURE);
     }
@@ -85,13 +87,13 @@ int main(int argc, char *argv[])
     words = 0;
     unique = createSet(MAX_SIZE, strcmp, strhash);
 
-    while (fscanf(fp, "%s", buffer) == 1) {
+    while (readWord(wp, buffer, BUFSIZ) == 1) {
         words ++;
 	if (!findElement(unique, buffer))
 	    addElement(unique, strdup(buffer));
     }
 
-    fclose(fp);
+    closeWords(wp);
 
     if (!lflag) {
 	printf("%d total words\n", words);
@@ -102,7 +104,7 @@ int main(int argc, char *argv[])
     /* Try to open the second file. */
 
     if (argc == 3) {
-        if ((fp = fopen(argv[2], "r")) == NULL) {
+        if ((wp = openWords(argv[2])) == NULL) {
             fprintf(stderr, "%s: cannot open %s\n", argv[0], argv[2]);
             exit(EXIT_FAILURE);
         }
@@ -110,14 +112,14 @@ int main(int argc, char *argv[])
 
         /* Delete all words in the second file. */
 
-        while (fscanf(fp, "%s", buffer) == 1) {
+        while (readWord(wp, buffer, BUFSIZ) == 1) {
 	    if ((word = findElement(unique, buffer)) != NULL) {
 		removeElement(unique, buffer);
 		free(word);
 	    }
 	}
 
-	fclose(fp);
+	closeWords(wp);
 
 	if (!lflag)
 	    printf("%d remaining words\n", numElements(unique));
@@ -127,12 +129,10 @@ int main(int argc, char *argv[])
     /* Print the list of words if desired. */
 
     if (lflag) {
-	elts = getElements(unique);
+	beginElements(unique, &cursor);
 
-	for (i = 0; i < numElements(unique); i ++)
-	    printf("%s\n", elts[i]);
-
-	free(elts);
+	while ((word = nextElement(&cursor)) != NULL)
+	    printf("%s\n", word);
     }
 
     destroySet(unique);